@@ -0,0 +1,50 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Battery_Percent
+// Power your Arduino straight from a battery, upload this code and open the Serial monitor.
+// Shows Vcc and the percent of charge left, from the built in curve of a Li-ion cell
+// and from a curve of your own, with no floating point math.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+// Your own curve, lowest Vcc first, e.g. to stop at 3.3V where a regulator drops out
+const MCUVoltageBatteryPoint myCurve[] PROGMEM =
+{
+  {3300, 0}, {3600, 20}, {3900, 80}, {4100, 100}
+};
+
+void setup() {
+  Serial.begin(9600);
+
+  // Or BATTERY_ALKALINE_2, BATTERY_NIMH_3, BATTERY_COIN
+  Vcc.setBattery(BATTERY_LIION);
+}
+
+void loop() {
+  unsigned long mV = Vcc.readmV(16);
+  byte percent = Vcc.convertToPercent(mV); // Or Vcc.readPercent(16) in one go
+
+  Serial.print(F("Vcc: "));
+  Serial.print(mV);
+  Serial.print(F("mV, Li-ion: "));
+  Serial.print(percent);
+
+  // Same reading on another curve, no new conversion needed
+  Vcc.setBattery(myCurve, sizeof(myCurve)/sizeof(myCurve[0]));
+  Serial.print(F("%, my curve: "));
+  Serial.print(Vcc.convertToPercent(mV));
+  Serial.println(F("%"));
+
+  Vcc.setBattery(BATTERY_LIION);
+
+  delay(1000);
+}
@@ -0,0 +1,96 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Benchmark_Conversion
+// Upload this code to your Arduino and open the Serial monitor.
+// Compares the CPU cycles taken to convert an ADC reading to millivolts
+// using the division free conversion (default) and the exact division.
+// No ADC reading is done, only the math is timed.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const unsigned int runs = 1000; // Conversions timed for each result
+volatile unsigned long sink; // Keeps the compiler from throwing the results away
+
+// Cycles taken for each conversion of readings with readingBitDepth bits
+unsigned long cyclesPerConversion(byte readingBitDepth)
+{
+  // Readings for Vcc from about 1.8V to 5.5V
+  unsigned long lowest = ((unsigned long)Vcc.getBandgap() << readingBitDepth) / 5500;
+  unsigned long highest = ((unsigned long)Vcc.getBandgap() << readingBitDepth) / 1800;
+  unsigned long step = (highest - lowest) / runs + 1;
+
+  unsigned long reading = lowest;
+  unsigned long start = micros();
+
+  for (unsigned int i=0; i<runs; i++)
+  {
+    sink = Vcc.convertTomV(reading, readingBitDepth);
+    reading += step;
+  }
+
+  unsigned long elapsed = micros() - start;
+
+  // Convert microseconds to cycles
+  return elapsed * (F_CPU / 1000000UL) / runs;
+}
+
+// Largest difference in millivolts between the two conversions
+unsigned long maxDifference(byte readingBitDepth)
+{
+  unsigned long lowest = ((unsigned long)Vcc.getBandgap() << readingBitDepth) / 5500;
+  unsigned long highest = ((unsigned long)Vcc.getBandgap() << readingBitDepth) / 1800;
+  unsigned long step = (highest - lowest) / runs + 1;
+  unsigned long maxDiff = 0;
+
+  for (unsigned long reading = lowest; reading <= highest; reading += step)
+  {
+    Vcc.setFastConversion(true);
+    unsigned long fast = Vcc.convertTomV(reading, readingBitDepth);
+    Vcc.setFastConversion(false);
+    unsigned long exact = Vcc.convertTomV(reading, readingBitDepth);
+
+    unsigned long diff = fast > exact ? fast - exact : exact - fast;
+    if (diff > maxDiff) { maxDiff = diff; }
+  }
+
+  return maxDiff;
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  Serial.println(F("Bits, division free cycles, division cycles, max difference (mV)"));
+
+  // Native bit depth and a few oversampled ones
+  for (byte bits = Vcc.getBitDepth(); bits <= 17; bits++)
+  {
+    Vcc.setFastConversion(true);
+    unsigned long fastCycles = cyclesPerConversion(bits);
+
+    Vcc.setFastConversion(false);
+    unsigned long divisionCycles = cyclesPerConversion(bits);
+
+    Serial.print(bits);
+    Serial.print(F(", "));
+    Serial.print(fastCycles);
+    Serial.print(F(", "));
+    Serial.print(divisionCycles);
+    Serial.print(F(", "));
+    Serial.println(maxDifference(bits));
+  }
+
+  // Back to default
+  Vcc.setFastConversion(true);
+}
+
+void loop() {
+}
@@ -0,0 +1,210 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Benchmark_Read_Paths
+// Upload this code to your Arduino and open the Serial monitor.
+// Times every read path for a range of bit depths and averaging times,
+// and prints one CSV line each, which can be pasted into a spreadsheet
+// or saved to compare library versions:
+//   device,api,bits,avg,cycles,us,conversions,mV
+// The ATmega counts CPU cycles with Timer 1, so do not use Timer 1 (eg Servo)
+// in this sketch. Other MCUs work out the cycles from micros().
+// conversions is left empty, the host simulation in extras/host counts them.
+// Every path is run once before it is timed, so the setup and bandgap settling
+// are not counted.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte avgs[] = {1, 4, 16, 64}; // Averaging times to try
+
+enum
+{
+  READMV, READMV_AVG, READ_AVG, READMV_OS, READMV_OS_AVG, READ_OS_AVG,
+  READMV_HWOS, READMV_HWOS_AVG, READ_HWOS_AVG
+};
+
+const char* const apiNames[] =
+{
+  "readmV", "readmV_avg", "read_avg", "readmV_OS", "readmV_OS_avg", "read_OS_avg",
+  "readmV_HWOS", "readmV_HWOS_avg", "read_HWOS_avg"
+};
+
+
+#if defined(TCCR1B)
+
+  // Timer 1 counts every CPU cycle, overflows are counted by the ISR
+  volatile unsigned long timerOverflows = 0;
+
+  ISR(TIMER1_OVF_vect)
+  {
+    timerOverflows++;
+  }
+
+  void startCycles()
+  {
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    timerOverflows = 0;
+    TIFR1 = 0b00000001;  // Clear the overflow flag
+    TIMSK1 = 0b00000001; // Overflow interrupt
+    TCCR1B = 0b00000001; // No prescaler
+  }
+
+  unsigned long stopCycles()
+  {
+    TCCR1B = 0; // Stop the timer
+
+    // Catch an overflow the ISR has not had a chance to count
+    unsigned long overflows = timerOverflows;
+    if (TIFR1 & 0b00000001) { overflows++; }
+
+    TIMSK1 = 0;
+
+    return (overflows << 16) + TCNT1;
+  }
+
+#else
+
+  unsigned long startMicros;
+
+  void startCycles()
+  {
+    startMicros = micros();
+  }
+
+  unsigned long stopCycles()
+  {
+    return (micros() - startMicros) * (F_CPU / 1000000UL);
+  }
+
+#endif
+
+
+// Same names as the host simulation prints
+const __FlashStringHelper* deviceName()
+{
+  switch (Vcc.getDevice())
+  {
+    case A_UNO:      return F("ATmega328P");
+    case A_LEO:      return F("ATmega32U4");
+    case A_MEGA:     return F("ATmega2560");
+    case ATTINY322X: return F("ATtiny3224");
+    case TINYAVR_01: return F("ATtiny1614");
+    case MEGAAVR_0:  return F("ATmega4809");
+    case AVR_DX:     return F("AVR128DA48");
+    default:         return F("Unknown");
+  }
+}
+
+
+// One call of the path, returns Vcc in millivolts
+unsigned long run(byte api, byte bits, byte avg)
+{
+  switch (api)
+  {
+    case READMV:        return Vcc.readmV();
+    case READMV_AVG:    return Vcc.readmV(avg);
+    case READ_AVG:      return Vcc.read(avg) * 1000 + 0.5;
+    case READMV_OS:     return Vcc.readmV_OS(bits);
+    case READMV_OS_AVG: return Vcc.readmV_OS(bits, avg);
+    case READ_OS_AVG:   return Vcc.read_OS(bits, avg) * 1000 + 0.5;
+
+    #if MCUVOLTAGE_HWOS
+      case READMV_HWOS:     return Vcc.readmV_HWOS(bits);
+      case READMV_HWOS_AVG: return Vcc.readmV_HWOS(bits, avg);
+      case READ_HWOS_AVG:   return Vcc.read_HWOS(bits, avg) * 1000 + 0.5;
+    #endif
+
+    default:            return 0;
+  }
+}
+
+
+void measure(byte api, byte bits, byte avg)
+{
+  // Warm up, so the setup and settling are not counted
+  run(api, bits, avg);
+
+  startCycles();
+  unsigned long mV = run(api, bits, avg);
+  unsigned long cycles = stopCycles();
+
+  Serial.print(deviceName());
+  Serial.print(',');
+  Serial.print(apiNames[api]);
+  Serial.print(',');
+  Serial.print(bits);
+  Serial.print(',');
+  Serial.print(avg);
+  Serial.print(',');
+  Serial.print(cycles);
+  Serial.print(',');
+  Serial.print(cycles / (F_CPU / 1000000UL));
+  Serial.print(F(",,"));
+  Serial.println(mV);
+
+  Serial.flush(); // Serial should not be sending while measuring
+}
+
+
+void setup() {
+  Serial.begin(9600);
+
+  const byte nativeBits = Vcc.getBitDepth();
+
+  Serial.println(F("device,api,bits,avg,cycles,us,conversions,mV"));
+
+  measure(READMV, nativeBits, 1);
+
+  for (byte a=0; a<sizeof(avgs); a++)
+  {
+    measure(READMV_AVG, nativeBits, avgs[a]);
+    measure(READ_AVG, nativeBits, avgs[a]);
+  }
+
+  // Up to 4 extra bits, past that it takes seconds
+  for (byte bits=nativeBits+1; bits<=nativeBits+4; bits++)
+  {
+    measure(READMV_OS, bits, 1);
+
+    for (byte a=0; a<sizeof(avgs); a++)
+    {
+      measure(READMV_OS_AVG, bits, avgs[a]);
+      measure(READ_OS_AVG, bits, avgs[a]);
+    }
+  }
+
+  #if MCUVOLTAGE_HWOS
+
+    // 13 to 17 bits on the ATtiny3224/3226/3227, 1 to 3 extra bits on the others
+    #if MCUVOLTAGE_SAMPNUM_ADC
+      const byte minBits = MCUVOLTAGE_BIT_DEPTH + 1, maxBits = MCUVOLTAGE_BIT_DEPTH + 3;
+    #else
+      const byte minBits = 13, maxBits = 17;
+    #endif
+
+    for (byte bits=minBits; bits<=maxBits; bits++)
+    {
+      measure(READMV_HWOS, bits, 1);
+
+      for (byte a=0; a<sizeof(avgs); a++)
+      {
+        measure(READMV_HWOS_AVG, bits, avgs[a]);
+        measure(READ_HWOS_AVG, bits, avgs[a]);
+      }
+    }
+
+  #endif
+}
+
+void loop() {
+}
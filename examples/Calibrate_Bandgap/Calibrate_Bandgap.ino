@@ -14,11 +14,14 @@
 // Take note of the actual bandgap voltage, you can use it
 // in your code to calibrate the Vcc readings by passing it in the 
 // constructor or use the setBandgap(unsigned int myBandgap) function.
+// See Calibrate_EEPROM to keep the calibration on the board instead.
 
 #include <MCUVoltage.h>
 
 MCUVoltage Vcc;
-float lastVcc, aVcc;
+unsigned long lastVcc; // In millivolts, so no float is needed
+long aVcc;
+char text[MCUVOLTAGE_FORMAT_SIZE];
 unsigned int newBg;
 char sep[] = "--------------------";
 
@@ -33,9 +36,10 @@ void loop()
   if (Serial.available()==0)
   {
     // Report Vcc
-    lastVcc = Vcc.read_OS(16,10);
+    lastVcc = Vcc.readmV_OS(16,10);
+    Vcc.formatmV(lastVcc, text);
     Serial.print("Vcc: ");
-    Serial.print(lastVcc,3);
+    Serial.print(text);
     Serial.println("V");
 
     Serial.print("Bandgap: ");
@@ -43,8 +47,8 @@ void loop()
     Serial.println("mV");
 
     Serial.println("Measure the Vcc with a digital multimeter and");
-    Serial.println("enter the actual value in volts into the Serial Monitor" );
-    Serial.println("(e.g. 4.95)");
+    Serial.println("enter the actual value in millivolts into the Serial Monitor" );
+    Serial.println("(e.g. 4950)");
     Serial.println(sep);
    
   }
@@ -52,8 +56,8 @@ void loop()
   // If there is something in the serial buffer
   else
   {
-    // Read it as a float
-    aVcc = Serial.parseFloat();
+    // Read it as a whole number of millivolts
+    aVcc = Serial.parseInt();
 
     // Reject the value if it is less than 0
     if (aVcc<=0)
@@ -67,10 +71,10 @@ void loop()
     {
       Serial.print("Actual Vcc: ");
       Serial.print(aVcc);
-      Serial.println("V");
+      Serial.println("mV");
 
-      // Calculate the actual bandgap voltage
-      newBg = aVcc/lastVcc*Vcc.getBandgap();
+      // Calculate the actual bandgap voltage, rounded
+      newBg = ((unsigned long)aVcc*Vcc.getBandgap() + lastVcc/2) / lastVcc;
 
       Serial.print("Bandgap should be: ");
       Serial.print(newBg);
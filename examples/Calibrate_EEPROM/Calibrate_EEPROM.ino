@@ -0,0 +1,108 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Calibrate_EEPROM
+// Upload code to Arduino, open the Serial Monitor.
+// Measure the actual Vcc using a digital multimeter and enter it in millivolts.
+// The first value gives a one point calibration. Change the supply voltage
+// (e.g. from 5V to 3.3V with a bench power supply) and enter a second value
+// for a two point calibration, which also corrects an offset.
+// The calibration is kept in the EEPROM, every sketch using MCUVoltage()
+// on this board loads it at power on. Enter 0 to start over.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+char text[MCUVOLTAGE_FORMAT_SIZE];
+char sep[] = "--------------------";
+
+// Points entered so far, Vcc read uncalibrated and on the multimeter
+byte points = 0;
+unsigned long measured1, actual1;
+
+void setup()
+{
+  Serial.begin(9600);
+}
+
+void loop()
+{
+  // If nothing in serial buffer
+  if (Serial.available()==0)
+  {
+    Vcc.formatmV(Vcc.readmV_OS(16,10), text);
+    Serial.print("Vcc: ");
+    Serial.print(text);
+    Serial.print("V, ");
+    Serial.println(Vcc.isCalibrated() ? "calibrated" : "not calibrated");
+
+    Serial.println("Enter the Vcc on the multimeter in millivolts (e.g. 4950), 0 to start over");
+    Serial.println(sep);
+  }
+
+  // If there is something in the serial buffer
+  else
+  {
+    long actual = Serial.parseInt();
+
+    // Clear the buffer
+    while(Serial.available()>0){Serial.read();}
+
+    // Read Vcc again without the calibration, both points must be read the same way
+    Vcc.clearCalibration();
+    unsigned long measured = Vcc.readmV_OS(16,10);
+
+    if (actual<=0)
+    {
+      points = 0;
+      Vcc.saveCalibration();
+      Serial.println("Calibration cleared.");
+    }
+
+    else if (points==0 || measured==measured1)
+    {
+      // One point, or the supply was not changed, so start with this one again
+      if (Vcc.calibrate(measured, actual))
+      {
+        measured1 = measured;
+        actual1 = actual;
+        points = 1;
+        Vcc.saveCalibration();
+        Serial.println("One point calibration saved.");
+      }
+      else
+      {
+        Vcc.loadCalibration();
+        Serial.println("Invalid value");
+      }
+    }
+
+    else
+    {
+      if (Vcc.calibrate(measured1, actual1, measured, actual))
+      {
+        Vcc.saveCalibration();
+        Serial.print("Two point calibration saved, offset ");
+        Serial.print(Vcc.getOffset_Calibration());
+        Serial.println("mV.");
+      }
+      else
+      {
+        Vcc.loadCalibration();
+        Serial.println("Invalid value");
+      }
+
+      points = 0;
+    }
+
+    Serial.println(sep);
+  }
+
+  delay(3000);
+}
@@ -0,0 +1,47 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Filter_Vcc
+// Upload this code to your Arduino and open the Serial plotter.
+// Tracks Vcc with one conversion per update, through three filters side by side:
+// a plain reading, an exponential moving average and a median of 5.
+// Switch a load such as a motor on and off to see spikes in the plain reading
+// that the median ignores.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+MCUVoltage VccEMA;
+MCUVoltage VccMedian;
+
+void setup() {
+  Serial.begin(9600);
+
+  // Sets up the ADC and waits for the bandgap to settle, readADC() below needs this
+  Vcc.readmV(4);
+
+  VccEMA.setFilter(FILTER_EMA, 4); // alpha is 1/16
+  VccMedian.setFilter(FILTER_MEDIAN, 5);
+
+  Serial.println(F("Raw(mV) EMA(mV) Median(mV)"));
+}
+
+void loop() {
+
+  // One conversion, shared by the three filters
+  unsigned int reading = Vcc.readADC();
+
+  Serial.print(Vcc.filtermV(reading));
+  Serial.print(F(" "));
+  Serial.print(VccEMA.filtermV(reading));
+  Serial.print(F(" "));
+  Serial.println(VccMedian.filtermV(reading));
+
+  delay(20);
+}
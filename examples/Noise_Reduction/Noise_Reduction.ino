@@ -0,0 +1,108 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Noise_Reduction
+// Upload this code to your Arduino and open the Serial monitor.
+// Measures how much the readings jump around (standard deviation) when averaging
+// different numbers of samples, with the CPU awake and with the CPU asleep
+// during each conversion (ADC noise reduction).
+// If the noise with the CPU asleep at a few samples matches the noise with
+// the CPU awake at many samples, the extra samples can be saved.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte trials = 32; // Number of averaged readings to work out the noise from
+const byte sampleCounts[] = {1, 4, 16, 64}; // Samples averaged for each reading
+
+// Integer square root
+unsigned long intSqrt(unsigned long value)
+{
+  unsigned long root = 0, bit = 1UL << 30;
+
+  while (bit > value) { bit >>= 2; }
+
+  while (bit != 0)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else { root >>= 1; }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+// Prints the standard deviation in 1/100 of an ADC step, and the time taken
+void measure(byte samples)
+{
+  long readings[trials];
+  long sum = 0;
+
+  unsigned long start = micros();
+
+  for (byte t=0; t<trials; t++)
+  {
+    unsigned long total = 0;
+    for (byte i=0; i<samples; i++) { total += Vcc.readADC(); }
+
+    // Average in 1/100 of an ADC step
+    readings[t] = total * 100 / samples;
+    sum += readings[t];
+  }
+
+  unsigned long elapsed = micros() - start;
+
+  long mean = sum / trials;
+  unsigned long sumOfSquares = 0;
+  for (byte t=0; t<trials; t++)
+  {
+    long diff = readings[t] - mean;
+    sumOfSquares += diff * diff;
+  }
+
+  Serial.print(samples);
+  Serial.print(F(", "));
+  Serial.print(Vcc.getNoiseReduction() ? F("asleep") : F("awake"));
+  Serial.print(F(", "));
+  Serial.print(intSqrt(sumOfSquares / trials));
+  Serial.print(F(", "));
+  Serial.println(elapsed / trials);
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  Vcc.ADCSetup();
+  Vcc.readADC(); // Throw away first reading
+
+  Serial.println(F("Samples, CPU, std dev (1/100 step), time per reading (us)"));
+  Serial.flush(); // Serial should not be sending while measuring
+}
+
+void loop() {
+
+  for (byte i=0; i<sizeof(sampleCounts); i++)
+  {
+    Vcc.setNoiseReduction(false);
+    measure(sampleCounts[i]);
+    Serial.flush();
+
+    Vcc.setNoiseReduction(true);
+    measure(sampleCounts[i]);
+    Serial.flush();
+  }
+
+  Serial.println(F("----------"));
+  delay(5000);
+}
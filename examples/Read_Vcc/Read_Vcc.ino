@@ -18,6 +18,15 @@ MCUVoltage Vcc;
 const byte os = 13; // Oversample to 13 bits
 const byte avg = 5; // Average results of 5 readings
 
+// Hardware oversample to 16 bits on the ATtiny 3224/3226/3227, 3 extra bits on the others
+#if MCUVOLTAGE_SAMPNUM_ADC
+  const byte hwos = MCUVOLTAGE_BIT_DEPTH + 3;
+#else
+  const byte hwos = 16;
+#endif
+
+char text[MCUVOLTAGE_FORMAT_SIZE]; // Vcc in volts as text, e.g. "4.987"
+
 void setup() {
   Serial.begin(9600);
 }
@@ -40,6 +49,15 @@ void loop() {
     case ATTINY322X:
       Serial.println(F("ATtiny3224/3226/3227"));
       break;
+    case TINYAVR_01:
+      Serial.println(F("tinyAVR 0/1-series"));
+      break;
+    case MEGAAVR_0:
+      Serial.println(F("megaAVR 0-series"));
+      break;
+    case AVR_DX:
+      Serial.println(F("AVR Dx"));
+      break;
     default:
       Serial.println(F("Unknown"));
       break;
@@ -47,7 +65,8 @@ void loop() {
 
   // Display regular readings
   Serial.print(F("Vcc: "));
-  Serial.print(Vcc.read(avg),3); // Use read() to get Vcc, display to 3 decimal places
+  Vcc.formatmV(Vcc.readmV(avg), text); // Use readmV() to get Vcc, formatmV() shows it in volts to 3 decimal places
+  Serial.print(text);
   Serial.print(F("V ("));
   Serial.print(Vcc.getLastADCReading()); // This displays the ADC reading of the bandgap voltage against Vcc as reference
   Serial.print(F("/"));
@@ -58,7 +77,8 @@ void loop() {
   
   // Display software oversampled readings
   Serial.print(F("Vcc: "));
-  Serial.print(Vcc.read_OS(os, avg),3); // Use read_OS() for oversampled readings
+  Vcc.formatmV(Vcc.readmV_OS(os, avg), text); // Use readmV_OS() for oversampled readings
+  Serial.print(text);
   Serial.print(F("V ("));
   Serial.print(Vcc.getLastADCReading()); // lastADCReading() can be used oversampled or not
   Serial.print(F("/"));
@@ -68,12 +88,13 @@ void loop() {
   Serial.println(F("bits)"));
 
 
-  // This part only compile for ATtiny 3324/3326/3327
-  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+  // This part only compile for ATtiny 3324/3326/3327, tinyAVR 0/1, megaAVR 0 and AVR Dx
+  #if MCUVOLTAGE_HWOS
 
   // Display hardware oversampled readings
   Serial.print(F("Vcc: "));
-  Serial.print(Vcc.read_HWOS(16, avg),3); // Hardware oversample to 16 bits
+  Vcc.formatmV(Vcc.readmV_HWOS(hwos, avg), text); // Hardware oversample to hwos bits
+  Serial.print(text);
   Serial.print(F("V ("));
   Serial.print(Vcc.getLastADCReading()); // lastADCReading() can be used oversampled or not
   Serial.print(F("/"));
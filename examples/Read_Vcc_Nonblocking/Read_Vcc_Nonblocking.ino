@@ -0,0 +1,51 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Read_Vcc_Nonblocking
+// Upload this code to your Arduino and open the Serial monitor.
+// The Vcc is read in the background by the ADC interrupt,
+// while loop() keeps counting to show the CPU is not waiting for the ADC.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte os = 13; // Oversample to 13 bits
+const byte avg = 5; // Average results of 5 readings
+
+unsigned long loopCount = 0;
+
+void setup() {
+  Serial.begin(9600);
+
+  // Start the first reading
+  Vcc.startReading_OS(os, avg);
+}
+
+void loop() {
+
+  // Check if the reading is done
+  if (Vcc.isReady())
+  {
+    Serial.print(F("Vcc: "));
+    Serial.print(Vcc.getmV()); // Result of the completed reading
+    Serial.print(F("mV, loop() ran "));
+    Serial.print(loopCount); // Work done while the ADC was busy
+    Serial.println(F(" times while reading"));
+
+    delay(1000);
+
+    // Start the next reading
+    loopCount = 0;
+    Vcc.startReading_OS(os, avg);
+  }
+
+  // Do other things here
+  loopCount++;
+}
@@ -0,0 +1,52 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Sample_Vcc_Background
+// Upload this code to your Arduino and open the Serial monitor.
+// The ADC runs freely in the background, filling a buffer with Vcc samples.
+// loop() takes whatever samples are ready and shows the lowest and highest Vcc.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte batch = 16; // Take at most 16 samples at a time
+unsigned int samples[batch];
+unsigned long mV[batch];
+
+void setup() {
+  Serial.begin(9600);
+
+  // Start the ADC in free running mode
+  Vcc.beginSampling();
+}
+
+void loop() {
+
+  delay(1000);
+
+  // Drain the samples collected so far
+  byte count = Vcc.readSamples(samples, batch);
+  Vcc.convertSamples(samples, mV, count);
+
+  unsigned long minmV = 0xFFFFFFFF, maxmV = 0;
+  for (byte i=0; i<count; i++)
+  {
+    if (mV[i] < minmV) { minmV = mV[i]; }
+    if (mV[i] > maxmV) { maxmV = mV[i]; }
+  }
+
+  Serial.print(count);
+  Serial.print(F(" samples, Vcc min: "));
+  Serial.print(minmV);
+  Serial.print(F("mV, max: "));
+  Serial.print(maxmV);
+  Serial.print(F("mV, dropped: "));
+  Serial.println(Vcc.getDroppedSamples()); // Samples lost because the buffer was full
+}
@@ -0,0 +1,73 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Sample_Vcc_Periodic
+// Upload this code to your Arduino and open the Serial monitor.
+// A timer starts the ADC exactly 1000 times a second, with no jitter from the code.
+// loop() drains the samples as they come and prints the lowest, highest and
+// average Vcc of every second.
+// Timer1 is used on the ATmega and TCB0 on the ATtiny3224/3226/3227, so
+// Servo, tone() or PWM on the pins of that timer cannot be used with this.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte batch = 16;
+unsigned int samples[batch];
+
+unsigned int  count = 0;
+unsigned long sum = 0;
+unsigned int  minReading = 0xFFFF, maxReading = 0;
+
+void setup() {
+  Serial.begin(9600);
+
+  // The rate that can really be done is returned
+  unsigned long rate = Vcc.setSamplingRate(1000);
+
+  Serial.print(F("Sampling at "));
+  Serial.print(rate);
+  Serial.println(F(" samples per second"));
+
+  Vcc.beginSampling();
+}
+
+void loop() {
+
+  // The buffer holds 31 samples, about 31ms at 1kHz, so drain it often
+  byte taken = Vcc.readSamples(samples, batch);
+
+  for (byte i=0; i<taken; i++)
+  {
+    sum += samples[i];
+    if (samples[i] < minReading) { minReading = samples[i]; }
+    if (samples[i] > maxReading) { maxReading = samples[i]; }
+  }
+
+  count += taken;
+
+  if (count >= 1000)
+  {
+    // A higher reading is a lower Vcc
+    Serial.print(F("Vcc min: "));
+    Serial.print(Vcc.convertTomV(maxReading, Vcc.getBitDepth()));
+    Serial.print(F("mV, max: "));
+    Serial.print(Vcc.convertTomV(minReading, Vcc.getBitDepth()));
+    Serial.print(F("mV, average: "));
+    Serial.print(Vcc.convertTomV((sum + count/2) / count, Vcc.getBitDepth()));
+    Serial.print(F("mV, dropped: "));
+    Serial.println(Vcc.getDroppedSamples());
+
+    count = 0;
+    sum = 0;
+    minReading = 0xFFFF;
+    maxReading = 0;
+  }
+}
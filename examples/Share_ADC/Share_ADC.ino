@@ -0,0 +1,49 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Share_ADC
+// Upload this code to your Arduino and open the Serial monitor.
+// Reads Vcc together with two analog pins, one against the default reference and
+// one against the internal reference. The queue reads everything that shares a
+// reference together, so the reference only switches when it has to, and puts the
+// ADC back the way analogRead() left it after reading Vcc.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const byte avg = 5; // Average results of 5 readings
+
+unsigned int  pinA0, pinA1;
+unsigned long mV;
+
+void setup() {
+  Serial.begin(9600);
+}
+
+void loop() {
+
+  // Queue in any order, A0 and Vcc share the default reference
+  Vcc.queueAnalogRead(A0, DEFAULT, &pinA0);
+  Vcc.queueAnalogRead(A1, INTERNAL, &pinA1);
+  Vcc.queueReading(&mV, avg);
+
+  // Do all the readings
+  Vcc.runQueue();
+
+  Serial.print(F("A0: "));
+  Serial.print(pinA0);
+  Serial.print(F(", A1: "));
+  Serial.print(pinA1);
+  Serial.print(F(", Vcc: "));
+  Serial.print(mV);
+  Serial.println(F("mV"));
+
+  delay(1000);
+}
@@ -0,0 +1,34 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Stream_Vcc
+// Upload this code to your Arduino and capture the Serial port to a file, not the Serial monitor,
+// the samples are sent as binary. Then turn them into CSV on the computer with
+// extras/host/stream_decode.cpp, for example on Linux:
+//   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > vcc.bin
+//   ./stream_decode vcc.bin > vcc.csv
+// Every raw sample is kept, about 8000 samples per second fit through 115200 baud,
+// so short dips such as brown-outs show up.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+void setup() {
+  Serial.begin(115200);
+
+  // Evenly spaced samples, not available on the tinyAVR 0/1, megaAVR 0 and AVR Dx which run freely
+  Vcc.setSamplingRate(5000);
+  Vcc.beginSampling();
+}
+
+void loop() {
+  // Send whatever the ADC collected as one frame, the header is sent by itself
+  Vcc.streamSamples(Serial);
+}
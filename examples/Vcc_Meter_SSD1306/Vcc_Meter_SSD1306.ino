@@ -36,6 +36,8 @@ const byte os = 12; // oversample to 12 bits, 13 in the case of ATtiny3224/3226/
 const byte avg = 5; // average 5 times
 const unsigned int period = 500; // wait 50ms before measuring again
 
+char voltage[MCUVOLTAGE_FORMAT_SIZE]; // Vcc in volts as text, no float needed
+
 
 void setup() {
   
@@ -63,13 +65,13 @@ void setup() {
 }
 
 void loop() {
-  float voltage = Vcc.read_OS(os, avg);
+  Vcc.formatmV(Vcc.readmV_OS(os, avg), voltage, 3);
 
   oled.fillRoundRect(rectX, rectY, rectW, rectH, 3, SSD1306_WHITE); // Draw white rectangle
   oled.setTextSize(2); // Big font size
   oled.setTextColor(SSD1306_BLACK); // Black text
   oled.setCursor(digitX, digitY);
-  oled.print(voltage, 3);
+  oled.print(voltage);
   oled.println(F("V"));
 
   oled.setTextSize(1); // Small font size
@@ -0,0 +1,40 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Vcc_Temperature_Compensated
+// Upload this code to your Arduino and open the Serial monitor.
+// The bandgap voltage drifts a little with temperature. This reads Vcc with
+// the bandgap moved by ppmPerC for every degree away from referenceC, using
+// the temperature sensor of the chip. Warm or cool the chip to see it.
+// Not for the Mega (ATmega2560), which has no temperature sensor.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const int ppmPerC = 50;                  // Found by reading a known Vcc at two temperatures
+const int referenceC = 25;               // Temperature the bandgap was set or calibrated at
+const unsigned long refreshMillis = 1000; // Read the temperature again after this long
+
+void setup() {
+  Serial.begin(9600);
+  Vcc.setTemperatureCompensation(ppmPerC, referenceC, refreshMillis);
+}
+
+void loop() {
+  unsigned long mV = Vcc.readmV(16);
+
+  Serial.print(F("Vcc: "));
+  Serial.print(mV);
+  Serial.print(F("mV at "));
+  Serial.print(Vcc.getTemperature());
+  Serial.println(F("C"));
+
+  delay(1000);
+}
@@ -0,0 +1,47 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Vcc_Zoom
+// Upload this code to your ATtiny 3224/3226/3227 and open the Serial monitor.
+// The PGA zooms in on Vcc around centremV, so 4 conversions give steps of about
+// 0.3mV at a gain of 16. When Vcc leaves the window, a regular reading is shown
+// instead and the window moves to it.
+// Only for the ATtiny 3224/3226/3227, which have a PGA.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const unsigned long centremV = 3300; // Where Vcc is expected to be
+const byte gain = 16;                // 1, 2, 4, 8 or 16, the window is about +-10V/gain
+
+void setup() {
+  Serial.begin(9600);
+  Vcc.setZoom(centremV, gain);
+}
+
+void loop() {
+  unsigned long uV = Vcc.readuV_Zoom(4);
+
+  Serial.print(F("Vcc: "));
+  Serial.print(uV / 1000);
+  Serial.print(F("."));
+
+  // Three decimal places of millivolts
+  unsigned int fraction = uV % 1000;
+  if (fraction < 100) { Serial.print(F("0")); }
+  if (fraction < 10) { Serial.print(F("0")); }
+  Serial.print(fraction);
+
+  Serial.print(F("mV"));
+  if (!Vcc.isInWindow_Zoom()) { Serial.print(F(" (out of window, now around ")); Serial.print(Vcc.getCentre_Zoom()); Serial.print(F("mV)")); }
+  Serial.println();
+
+  delay(1000);
+}
@@ -0,0 +1,63 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Example: Watch_Vcc
+// Upload this code to your Arduino and open the Serial monitor.
+// Instead of reading Vcc over and over, the ADC watches it and the callback
+// is called only when Vcc leaves the window around the Vcc at start.
+// Change the supply voltage (e.g. with a bench supply) to see it.
+
+#include <MCUVoltage.h>
+
+MCUVoltage Vcc;
+
+const unsigned int windowmV = 100; // Window is +/- this much around the Vcc at start
+
+volatile bool left = false;
+volatile unsigned long leftmV = 0;
+
+// Called from inside an interrupt, keep it short
+void vccLeft(unsigned long mV)
+{
+  leftmV = mV;
+  left = true;
+}
+
+void startWatching()
+{
+  unsigned long mV = Vcc.readmV(16);
+
+  Serial.print(F("Watching "));
+  Serial.print(mV - windowmV);
+  Serial.print(F("mV to "));
+  Serial.print(mV + windowmV);
+  Serial.println(F("mV"));
+
+  Vcc.watch(mV - windowmV, mV + windowmV, vccLeft);
+}
+
+void setup() {
+  Serial.begin(9600);
+  startWatching();
+}
+
+void loop() {
+
+  // Free to do anything else here, except using the ADC
+  if (left)
+  {
+    left = false;
+
+    Serial.print(F("Vcc left the window: "));
+    Serial.print(leftmV);
+    Serial.println(F("mV"));
+
+    startWatching();
+  }
+}
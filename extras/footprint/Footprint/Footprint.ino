@@ -0,0 +1,53 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+// Compiled once for every FOOTPRINT_API by footprint.sh, which reports how much
+// flash and SRAM each read path adds over an empty sketch (FOOTPRINT_API 0).
+
+#include <MCUVoltage.h>
+
+#ifndef FOOTPRINT_API
+  #define FOOTPRINT_API 0
+#endif
+
+volatile unsigned long sink; // Keeps the compiler from throwing the result away
+
+void setup() {
+
+  #if FOOTPRINT_API > 0
+    MCUVoltage Vcc;
+  #endif
+
+  #if FOOTPRINT_API == 1
+    sink = Vcc.readmV();
+  #elif FOOTPRINT_API == 2
+    sink = Vcc.readmV(5);
+  #elif FOOTPRINT_API == 3
+    sink = Vcc.read(5);
+  #elif FOOTPRINT_API == 4
+    sink = Vcc.readmV_OS(13, 5);
+  #elif FOOTPRINT_API == 5
+    sink = Vcc.read_OS(13, 5);
+  #elif FOOTPRINT_API == 6
+    sink = Vcc.readmV_Adaptive(2, 64);
+  #elif FOOTPRINT_API == 7
+    Vcc.startReading(5);
+    while (!Vcc.isReady()) {}
+    sink = Vcc.getmV();
+  #elif FOOTPRINT_API == 8
+    sink = MCUVoltageT<13, 5>::readmV();
+  #elif FOOTPRINT_API == 9 && MCUVOLTAGE_HWOS
+    sink = Vcc.readmV_HWOS(MCUVOLTAGE_BIT_DEPTH + 3, 5);
+  #elif FOOTPRINT_API == 10 && MCUVOLTAGE_HWOS
+    sink = Vcc.read_HWOS(MCUVOLTAGE_BIT_DEPTH + 3, 5);
+  #endif
+}
+
+void loop() {
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# MCU Voltage by cygig v0.4.4
+# https://github.com/cygig/MCUVoltage
+#
+# Prints the flash and SRAM each read path adds over an empty sketch, as CSV:
+#   fqbn,api,flash,sram
+# Needs arduino-cli with the core of the board installed, run from the library folder:
+#   sh extras/footprint/footprint.sh arduino:avr:uno
+# The fqbn defaults to arduino:avr:uno. APIs 9 and 10 (hardware oversampling)
+# are only different from 0 on the ATtiny3224/3226/3227.
+
+fqbn=${1:-arduino:avr:uno}
+sketch=$(dirname "$0")/Footprint
+names="empty readmV readmV_avg read_avg readmV_OS_avg read_OS_avg readmV_Adaptive startReading_avg MCUVoltageT_readmV readmV_HWOS_avg read_HWOS_avg"
+
+echo "fqbn,api,flash,sram"
+
+api=0
+baseFlash=0
+baseSRAM=0
+
+for name in $names; do
+  output=$(arduino-cli compile --fqbn "$fqbn" --library . \
+           --build-property "compiler.cpp.extra_flags=-DFOOTPRINT_API=$api" "$sketch" 2>&1) || {
+    echo "$fqbn,$name,error,error"
+    api=$((api + 1))
+    continue
+  }
+
+  flash=$(echo "$output" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+  sram=$(echo "$output" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+
+  if [ "$api" -eq 0 ]; then
+    baseFlash=$flash
+    baseSRAM=$sram
+  fi
+
+  echo "$fqbn,$name,$((flash - baseFlash)),$((sram - baseSRAM))"
+  api=$((api + 1))
+done
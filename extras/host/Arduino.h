@@ -0,0 +1,132 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Arduino Core */
+
+/*
+ * Just enough of the Arduino core for the library, with time and analogRead()
+ * driven by the ADC model in MCUVoltageSim.cpp.
+ */
+
+
+#ifndef MCUVOLTAGESIM_ARDUINO_H
+#define MCUVOLTAGESIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#ifndef F_CPU
+  #define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// No flash strings on the host
+#define F(string) (string)
+
+unsigned long micros();
+unsigned long millis();
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+
+int           analogRead(uint8_t pin);
+void          analogReference(uint8_t mode);
+
+// Output of streamSamples(), like the Print of the Arduino core that Serial derives from
+class Print
+{
+  public:
+
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+      size_t count = 0;
+      while (size-- > 0) { count += write(*buffer++); }
+      return count;
+    }
+};
+
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // REFSEL of ADC0.CTRLC
+  #define DEFAULT       0
+  #define VDD           0
+  #define INTERNAL1V024 4
+  #define INTERNAL2V048 5
+  #define INTERNAL2V500 6
+  #define INTERNAL4V096 7
+  #define INTERNAL      INTERNAL1V024
+
+  // Analog channels are used as the pin numbers
+  #define A0 0
+  #define A1 1
+  #define A2 2
+  #define A3 3
+  #define A4 4
+  #define A5 5
+  #define A6 6
+  #define A7 7
+
+#elif defined(__AVR_ATtiny1614__) || defined(__AVR_ATmega4809__) || defined(__AVR_AVR128DA48__)
+
+  #if defined(__AVR_AVR128DA48__)
+
+    // REFSEL of VREF.ADC0REF
+    #define INTERNAL1V024 0
+    #define INTERNAL2V048 1
+    #define INTERNAL4V096 2
+    #define INTERNAL2V500 3
+    #define DEFAULT       5
+    #define VDD           5
+    #define EXTERNAL      6
+    #define INTERNAL      INTERNAL1V024
+
+  #else
+
+    // REFSEL of ADC0.CTRLC, INTERNAL is the 1.1V ADC0 reference of VREF
+    #define INTERNAL 0
+    #define DEFAULT  1
+    #define VDD      1
+    #define EXTERNAL 2
+
+  #endif
+
+  // Analog channels are used as the pin numbers
+  #define A0 0
+  #define A1 1
+  #define A2 2
+  #define A3 3
+  #define A4 4
+  #define A5 5
+  #define A6 6
+  #define A7 7
+
+#else
+
+  // REFS1:0 of ADMUX
+  #define EXTERNAL 0
+  #define DEFAULT  1
+  #define INTERNAL 3
+
+  // Pin numbers of an Uno, analogRead() also takes the channel
+  #define A0 14
+  #define A1 15
+  #define A2 16
+  #define A3 17
+  #define A4 18
+  #define A5 19
+  #define A6 20
+  #define A7 21
+
+#endif
+
+#endif
@@ -0,0 +1,1301 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: ADC Model */
+
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <math.h>
+
+
+// Defined by the library only if it uses the ADC interrupt
+extern "C" void ADC_vect(void) __attribute__((weak));
+extern "C" void ADC0_RESRDY_vect(void) __attribute__((weak));
+extern "C" void ADC0_WCMP_vect(void) __attribute__((weak));
+extern "C" void ADC0_WCOMP_vect(void) __attribute__((weak));
+
+
+// The registers the library sees
+SimRegister<uint8_t> SREG(SIM_SREG);
+
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  #define SIM_TINY 1
+  #define SIM_SAMPNUM 0
+
+  SimADC   ADC0;
+  SimVREF  VREF;
+  SimAC    AC0;
+  SimTCB   TCB0(0);
+  SimTCB   TCB1(1);
+  SimEVSYS EVSYS;
+
+  // Kelvin = ((TEMPSENSE1 - reading)*TEMPSENSE0 + 0x800) >> 12
+  const SimSIGROW SIGROW = {2000, 2900};
+
+  static const uint32_t fullScale = 4096;
+  static const double   defaultBandgap = 1024;
+
+  // Settles to 12 bits in about 50us
+  static const double   defaultTau = 6;
+
+  // CLK_PER is divided by these for CLK_ADC, index is the PRESC bits in CTRLB
+  static const uint8_t prescalers[] = {2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64};
+
+#elif defined(__AVR_ATtiny1614__) || defined(__AVR_ATmega4809__) || defined(__AVR_AVR128DA48__)
+
+  #define SIM_TINY 0
+  #define SIM_SAMPNUM 1
+
+  SimADC   ADC0;
+  SimVREF  VREF;
+
+  #if defined(AC0_DACREF)
+    SimAC  AC0;
+  #endif
+
+  #if defined(__AVR_AVR128DA48__)
+
+    // Kelvin = ((TEMPSENSE1 - reading)*TEMPSENSE0 + 0x800) >> 12, against 2.048V
+    const SimSIGROW SIGROW = {2000, 2900};
+
+    static const uint32_t fullScale = 4096;
+    static const double   defaultBandgap = 1024;
+
+    // CLK_PER is divided by these for CLK_ADC, index is the PRESC bits in CTRLC.
+    // 2 cycles to sample and 13 to convert 12 bits, SAMPLEN adds to the sampling.
+    static const uint16_t prescalers[] = {2, 4, 8, 12, 16, 20, 24, 28, 32, 48, 64, 96, 128, 256};
+    static const uint8_t  conversionCycles = 15;
+
+    // The window compare vector is called WCMP
+    #define SIM_WINDOW_VECT ADC0_WCMP_vect
+
+  #else
+
+    // Kelvin = ((reading - TEMPSENSE1)*TEMPSENSE0 + 0x80) >> 8, against 1.1V, TEMPSENSE1 is signed
+    const SimSIGROW SIGROW = {143, 246};
+
+    static const uint32_t fullScale = 1024;
+    static const double   defaultBandgap = 1100;
+
+    // CLK_PER is divided by these for CLK_ADC, index is the PRESC bits in CTRLC.
+    // 13 cycles to sample and convert 10 bits, SAMPLEN adds to the sampling.
+    static const uint16_t prescalers[] = {2, 4, 8, 16, 32, 64, 128, 256};
+    static const uint8_t  conversionCycles = 13;
+
+    // The window compare vector is called WCOMP
+    #define SIM_WINDOW_VECT ADC0_WCOMP_vect
+
+  #endif
+
+  // Settles in about 50us
+  static const double   defaultTau = 6;
+
+#else
+
+  #define SIM_TINY 0
+  #define SIM_SAMPNUM 0
+
+  SimRegister<uint8_t> ADMUX(SIM_ADMUX);
+  SimRegister<uint8_t> ADCSRA(SIM_ADCSRA);
+  SimRegister<uint8_t> ADCSRB(SIM_ADCSRB);
+  SimRegister<uint8_t> ADCL(SIM_ADCL);
+  SimRegister<uint8_t> ADCH(SIM_ADCH);
+
+  SimRegister<uint8_t>  TCCR1A(SIM_TCCR1A);
+  SimRegister<uint8_t>  TCCR1B(SIM_TCCR1B);
+  SimRegister<uint16_t> TCNT1(SIM_TCNT1);
+  SimRegister<uint16_t> OCR1A(SIM_OCR1A);
+  SimRegister<uint16_t> OCR1B(SIM_OCR1B);
+  SimRegister<uint8_t>  TIFR1(SIM_TIFR1);
+
+  static const uint32_t fullScale = 1024;
+  static const double   defaultBandgap = 1100;
+
+  // Settles to 10 bits in about 70us
+  static const double   defaultTau = 10;
+
+#endif
+
+// Channel number the model uses for the bandgap or DACREF0, whatever the device calls it
+#define SIM_BANDGAP_CHANNEL 0xFE
+
+// Channel number the model uses for the temperature sensor
+#define SIM_TEMPERATURE_CHANNEL 0xFD
+
+// Channel number the model uses for Vcc divided by 10
+#define SIM_VDDDIV10_CHANNEL 0xFC
+
+// CPU cycles taken by every register access, about one turn of a polling loop
+#define SIM_ACCESS_CYCLES 4
+
+// Timer0 overflows every 64*256 CPU cycles, as set up by the Arduino core for millis()
+#define SIM_TIMER0_OVERFLOW_CYCLES (64 * 256)
+
+
+/*================================================================================*/
+
+
+// Register contents
+static uint32_t regs[SIM_REGISTER_COUNT];
+
+// Time
+static uint64_t cycles = 0;
+
+// Conversion in progress
+static bool     converting = false;
+static uint64_t startedAt = 0;
+static uint64_t doneAt = 0;
+static uint32_t pendingResult = 0;
+static uint32_t pendingSample = 0; // Last sample of an accumulated result
+static bool     firstConversion = true;
+static uint32_t conversions = 0;
+
+// Input
+static double   vccmV = 5000;
+static double   (*vccWaveform)(double seconds) = NULL;
+static double   rippleAmplitude = 0;
+static double   rippleHz = 0;
+static double   bandgapmV = defaultBandgap;
+static double   celsius = 25;
+static double   bandgapTempco = 0;
+static double   tauMicros = defaultTau;
+static double   noiseRMS = 0.5;
+static uint32_t randomState = 1;
+static double   pinmV[16];
+
+// Bandgap settling, the input moves from switchFrom towards the bandgap after switchAt
+static uint8_t  lastChannel = 0xFF;
+static uint64_t switchAt = 0;
+static double   switchFrom = 0;
+
+// When the timers that can start the ADC were last started from 0
+static uint64_t timerStartAt[2];
+
+static bool     inISR = false;
+static uint8_t  analogReferenceMode = DEFAULT;
+
+
+/*================================================================================*/
+
+
+static double seconds(uint64_t atCycles)
+{
+  return (double)atCycles / F_CPU;
+}
+
+
+// Gaussian noise from xorshift32 and Box-Muller
+static double gaussian()
+{
+  double u[2];
+
+  for (int i=0; i<2; i++)
+  {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    u[i] = (randomState + 1.0) / 4294967297.0;
+  }
+
+  return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+
+// Bandgap at the temperature right now
+static double bandgapNow()
+{
+  return bandgapmV * (1.0 + bandgapTempco * (celsius - 25) / 1e6);
+}
+
+
+static double simGetVccAt(uint64_t atCycles)
+{
+  double mV = vccWaveform != NULL ? vccWaveform(seconds(atCycles)) : vccmV;
+
+  return mV + rippleAmplitude * sin(2.0 * M_PI * rippleHz * seconds(atCycles));
+}
+
+
+/*================================================================================*/
+
+
+#if SIM_TINY
+
+  // Channel selected by MUXPOS without VIA (Bit 7:6), DACREF0 is the one the library reads
+  static uint8_t channel()
+  {
+    uint8_t mux = regs[SIM_ADC0_MUXPOS] & 0b00111111;
+
+    if (mux == 0b00110011) { return SIM_BANDGAP_CHANNEL; }
+    if (mux == 0b00110010) { return SIM_TEMPERATURE_CHANNEL; }
+    if (mux == 0b00110001) { return SIM_VDDDIV10_CHANNEL; }
+    return mux;
+  }
+
+  // VREF for DACREF0, REFSEL of VREF.CTRLA
+  static double internalReference(uint8_t refsel)
+  {
+    switch (refsel)
+    {
+      case 1: return bandgapNow() * 2;      // 2.048V
+      case 2: return bandgapNow() * 4;      // 4.096V
+      case 3: return bandgapNow() * 2500 / 1024; // 2.5V
+      default: return bandgapNow();         // 1.024V
+    }
+  }
+
+  static double bandgapInput()
+  {
+    return internalReference(regs[SIM_VREF_CTRLA] & 0b00000111) * regs[SIM_AC0_DACREF] / 256.0;
+  }
+
+  // Input selected by MUXNEG without VIA (Bit 7:6), for differential conversions
+  static double negativemV(uint64_t atCycles)
+  {
+    uint8_t mux = regs[SIM_ADC0_MUXNEG] & 0b00111111;
+
+    if (mux == 0b00110011) { return bandgapInput(); }
+    if (mux == 0b00110001) { return simGetVccAt(atCycles) / 10; }
+    return mux < 16 ? pinmV[mux] : 0; // GND and anything not modelled
+  }
+
+  // GAIN (Bit 7:5) of PGACTRL when the positive input goes through the enabled PGA, else 1
+  static double gain()
+  {
+    if ((regs[SIM_ADC0_MUXPOS] & 0b11000000) != 0b01000000) { return 1; }
+    if (!(regs[SIM_ADC0_PGACTRL] & 0b00000001)) { return 1; }
+
+    return 1 << ((regs[SIM_ADC0_PGACTRL] >> 5) & 0b00000111);
+  }
+
+  // Reference of the ADC, REFSEL of CTRLC
+  static double referencemV(uint64_t atCycles)
+  {
+    switch (regs[SIM_ADC0_CTRLC] & 0b00000111)
+    {
+      case 4: return bandgapNow();
+      case 5: return bandgapNow() * 2;
+      case 6: return bandgapNow() * 2500 / 1024;
+      case 7: return bandgapNow() * 4;
+      default: return simGetVccAt(atCycles); // VDD, or VREFA tied to VDD
+    }
+  }
+
+  static bool enabled()
+  {
+    return regs[SIM_ADC0_CTRLA] & 0b00000001;
+  }
+
+  // CPU cycles for one sample
+  static uint64_t sampleCycles()
+  {
+    return (uint64_t)prescalers[regs[SIM_ADC0_CTRLB] & 0b00001111] * (15 + regs[SIM_ADC0_CTRLE]);
+  }
+
+#elif SIM_SAMPNUM
+
+  // Channel selected by MUXPOS, the internal reference the library reads is the bandgap channel
+  static uint8_t channel()
+  {
+    uint8_t mux = regs[SIM_ADC0_MUXPOS];
+
+    #if defined(__AVR_AVR128DA48__)
+      if (mux == 0b01001001) { return SIM_BANDGAP_CHANNEL; }     // DACREF0
+      if (mux == 0b01000010) { return SIM_TEMPERATURE_CHANNEL; } // TEMPSENSE
+    #elif defined(__AVR_ATmega4809__)
+      if (mux == 0b00011100) { return SIM_BANDGAP_CHANNEL; }     // DACREF
+      if (mux == 0b00011110) { return SIM_TEMPERATURE_CHANNEL; } // TEMPSENSE
+    #else
+      if (mux == 0b00011101) { return SIM_BANDGAP_CHANNEL; }     // INTREF
+      if (mux == 0b00011110) { return SIM_TEMPERATURE_CHANNEL; } // TEMPSENSE
+    #endif
+
+    return mux;
+  }
+
+  // Voltage of VREF for the given REFSEL
+  static double internalReference(uint8_t refsel)
+  {
+    #if defined(__AVR_AVR128DA48__)
+
+      switch (refsel)
+      {
+        case 1: return bandgapNow() * 2;      // 2.048V
+        case 2: return bandgapNow() * 4;      // 4.096V
+        case 3: return bandgapNow() * 2500 / 1024; // 2.5V
+        default: return bandgapNow();         // 1.024V
+      }
+
+    #else
+
+      switch (refsel)
+      {
+        case 0: return bandgapNow() / 2;      // 0.55V
+        case 2: return bandgapNow() * 2500 / 1100; // 2.5V
+        case 3: return bandgapNow() * 4300 / 1100; // 4.3V
+        case 4: return bandgapNow() * 1500 / 1100; // 1.5V
+        default: return bandgapNow();         // 1.1V
+      }
+
+    #endif
+  }
+
+  static double bandgapInput()
+  {
+    #if defined(__AVR_AVR128DA48__)
+      return internalReference(regs[SIM_VREF_ACREF] & 0b00000111) * regs[SIM_AC0_DACREF] / 256.0;
+    #elif defined(__AVR_ATmega4809__)
+      return internalReference(regs[SIM_VREF_CTRLA] & 0b00000111) * regs[SIM_AC0_DACREF] / 256.0;
+    #else
+      return internalReference((regs[SIM_VREF_CTRLA] >> 4) & 0b00000111);
+    #endif
+  }
+
+  // Reference of the ADC, REFSEL of VREF.ADC0REF (AVR Dx) or ADC0.CTRLC (others)
+  static double referencemV(uint64_t atCycles)
+  {
+    #if defined(__AVR_AVR128DA48__)
+
+      uint8_t refsel = regs[SIM_VREF_ADC0REF] & 0b00000111;
+      if (refsel >= 4) { return simGetVccAt(atCycles); } // VDD, or VREFA tied to VDD
+      return internalReference(refsel);
+
+    #else
+
+      if ((regs[SIM_ADC0_CTRLC] & 0b00110000) == 0) { return internalReference((regs[SIM_VREF_CTRLA] >> 4) & 0b00000111); }
+      return simGetVccAt(atCycles); // VDD, or VREFA tied to VDD
+
+    #endif
+  }
+
+  static bool enabled()
+  {
+    return regs[SIM_ADC0_CTRLA] & 0b00000001;
+  }
+
+  // CPU cycles for one sample
+  static uint64_t sampleCycles()
+  {
+    const uint8_t lastPresc = sizeof(prescalers) / sizeof(prescalers[0]) - 1;
+
+    uint8_t presc = regs[SIM_ADC0_CTRLC] & 0b00001111;
+    if (presc > lastPresc) { presc = lastPresc; }
+
+    return (uint64_t)prescalers[presc] * (conversionCycles + regs[SIM_ADC0_SAMPCTRL]);
+  }
+
+#else
+
+  static uint8_t channel()
+  {
+    uint8_t mux;
+
+    #if defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__) || \
+        defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) || \
+        defined(__AVR_ATmega1281__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
+
+      #if defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+        const uint8_t MUX5 = 0b00100000;
+      #else
+        const uint8_t MUX5 = 0b00001000;
+      #endif
+
+      mux = regs[SIM_ADMUX] & 0b00011111;
+      if (regs[SIM_ADCSRB] & MUX5) { mux |= 0b00100000; }
+      if (mux == 0b00011110) { return SIM_BANDGAP_CHANNEL; }
+
+      #if defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+        if (mux == 0b00100111) { return SIM_TEMPERATURE_CHANNEL; }
+      #endif
+
+      if (mux >= 0b00100000) { return 8 + (mux & 0b00000111); }
+
+    #else
+
+      mux = regs[SIM_ADMUX] & 0b00001111;
+      if (mux == 0b00001110) { return SIM_BANDGAP_CHANNEL; }
+      if (mux == 0b00001000) { return SIM_TEMPERATURE_CHANNEL; }
+
+    #endif
+
+    return mux;
+  }
+
+  static double bandgapInput()
+  {
+    return bandgapNow();
+  }
+
+  // Reference of the ADC, REFS1:0 of ADMUX. 2.56V is made from the bandgap too.
+  static double referencemV(uint64_t atCycles)
+  {
+    switch (regs[SIM_ADMUX] >> 6)
+    {
+      #if defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+        case 3: return bandgapNow() * 2560 / 1100;
+      #elif defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) || \
+            defined(__AVR_ATmega1281__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
+        case 2: return bandgapNow();
+        case 3: return bandgapNow() * 2560 / 1100;
+      #else
+        case 3: return bandgapNow();
+      #endif
+      default: return simGetVccAt(atCycles); // AVcc, or AREF tied to AVcc
+    }
+  }
+
+  static bool enabled()
+  {
+    return regs[SIM_ADCSRA] & 0b10000000;
+  }
+
+  // CPU cycles for one ADC clock cycle
+  static uint64_t clockCycles()
+  {
+    uint8_t ADPS = regs[SIM_ADCSRA] & 0b00000111;
+    if (ADPS == 0) { ADPS = 1; }
+
+    return 1ULL << ADPS;
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Output of the temperature sensor, as typical in the datasheets
+static double temperaturemV()
+{
+  #if SIM_TINY
+    // Inverse of the SIGROW formula against the 1.024V reference, which the calibration includes
+    double reading = SIGROW.TEMPSENSE1 - (celsius + 273.15) * 4096.0 / SIGROW.TEMPSENSE0;
+    return reading * bandgapNow() / 4096;
+  #elif SIM_SAMPNUM && defined(__AVR_AVR128DA48__)
+    // Inverse of the SIGROW formula against the 2.048V reference
+    double reading = SIGROW.TEMPSENSE1 - (celsius + 273.15) * 4096.0 / SIGROW.TEMPSENSE0;
+    return reading * bandgapNow() * 2 / 4096;
+  #elif SIM_SAMPNUM
+    // Inverse of the SIGROW formula against the 1.1V reference, the offset is signed
+    double reading = (celsius + 273.15) * 256.0 / SIGROW.TEMPSENSE0 + (int8_t)SIGROW.TEMPSENSE1;
+    return reading * bandgapNow() / 1024;
+  #elif defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+    return 880 + (celsius - 25) * 3.25;
+  #else
+    return 314 + (celsius - 25);
+  #endif
+}
+
+
+// Input voltage of the selected channel, the bandgap settles after the mux switches to it
+static double inputmV(uint64_t atCycles)
+{
+  uint8_t ch = channel();
+
+  if (ch == SIM_TEMPERATURE_CHANNEL) { return temperaturemV(); }
+  if (ch == SIM_VDDDIV10_CHANNEL) { return simGetVccAt(atCycles) / 10; }
+  if (ch != SIM_BANDGAP_CHANNEL) { return ch < 16 ? pinmV[ch] : 0; }
+
+  double settled = bandgapInput();
+  if (tauMicros <= 0 || atCycles < switchAt) { return settled; }
+
+  double elapsedMicros = (atCycles - switchAt) * 1e6 / F_CPU;
+
+  return settled + (switchFrom - settled) * exp(-elapsedMicros / tauMicros);
+}
+
+
+// Note when the input changes, so the bandgap can be made to settle
+static void checkSwitch(double previousInput)
+{
+  uint8_t ch = enabled() ? channel() : 0xFF;
+
+  if (ch == lastChannel) { return; }
+
+  lastChannel = ch;
+  switchAt = cycles;
+  switchFrom = previousInput;
+}
+
+
+// One sample of the input, in ADC steps
+static uint32_t sample(uint64_t atCycles)
+{
+  conversions++;
+
+  #if SIM_TINY
+
+    // Differential (DIFF, Bit 7 of COMMAND), signed and sign extended to 32 bits
+    if (regs[SIM_ADC0_COMMAND] & 0b10000000)
+    {
+      double diff = (inputmV(atCycles) - negativemV(atCycles)) * gain();
+      double signedCode = diff / referencemV(atCycles) * (fullScale / 2) + noiseRMS * gaussian();
+
+      if (signedCode < -(double)(fullScale / 2)) { signedCode = -(double)(fullScale / 2); }
+      if (signedCode > fullScale / 2 - 1) { signedCode = fullScale / 2 - 1; }
+
+      return (uint32_t)(int32_t)floor(signedCode);
+    }
+
+  #endif
+
+  double code = inputmV(atCycles) / referencemV(atCycles) * fullScale + noiseRMS * gaussian();
+
+  if (code < 0) { return 0; }
+  if (code > fullScale - 1) { return fullScale - 1; }
+
+  return (uint32_t)code;
+}
+
+
+/*================================================================================*/
+
+
+#if SIM_TINY
+
+  // Result compared against WINLT and WINHT as set by WINCM (Bit 2:0) of CTRLD,
+  // SAMPLE instead of RESULT when WINSRC (Bit 3) is set
+  static bool windowMatched()
+  {
+    uint32_t value = (regs[SIM_ADC0_CTRLD] & 0b00001000) ? regs[SIM_ADC0_SAMPLE] : regs[SIM_ADC0_RESULT];
+    uint32_t low = regs[SIM_ADC0_WINLT];
+    uint32_t high = regs[SIM_ADC0_WINHT];
+
+    switch (regs[SIM_ADC0_CTRLD] & 0b00000111)
+    {
+      case 1: return value < low;
+      case 2: return value > high;
+      case 3: return value >= low && value <= high;
+      case 4: return value < low || value > high;
+      default: return false;
+    }
+  }
+
+#elif SIM_SAMPNUM
+
+  // RES compared against WINLT and WINHT as set by WINCM (Bit 2:0) of CTRLE
+  static bool windowMatched()
+  {
+    uint32_t value = regs[SIM_ADC0_RES];
+    uint32_t low = regs[SIM_ADC0_WINLT];
+    uint32_t high = regs[SIM_ADC0_WINHT];
+
+    switch (regs[SIM_ADC0_CTRLE] & 0b00000111)
+    {
+      case 1: return value < low;
+      case 2: return value > high;
+      case 3: return value >= low && value <= high;
+      case 4: return value < low || value > high;
+      default: return false;
+    }
+  }
+
+#else
+
+  // ADTS of ADCSRB
+  static uint8_t triggerSource()
+  {
+    #if defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+      return regs[SIM_ADCSRB] & 0b00001111;
+    #else
+      return regs[SIM_ADCSRB] & 0b00000111;
+    #endif
+  }
+
+#endif
+
+static void startConversion(uint64_t atCycles);
+
+// Next time at or after afterCycles that a timer with the given period fires, counting from startAt
+static uint64_t nextPeriod(uint64_t startAt, uint64_t period, uint64_t afterCycles)
+{
+  if (afterCycles < startAt) { return startAt + period; }
+
+  return startAt + ((afterCycles - startAt) / period + 1) * period;
+}
+
+
+#if SIM_TINY
+
+  // CPU cycles between conversions started by the event system, 0 if none.
+  // Only a TCB in periodic interrupt mode (CAPT) routed to ADC0 START is modelled.
+  static uint64_t triggerPeriod(uint64_t& startAt)
+  {
+    if ((regs[SIM_ADC0_COMMAND] & 0b00000111) != 4) { return 0; }
+
+    uint8_t user = regs[SIM_EVSYS_USERADC0START];
+    if (user == 0 || user > 6) { return 0; }
+
+    uint8_t generator = regs[SIM_EVSYS_CHANNEL0 + user - 1];
+    if (generator != 0xA0 && generator != 0xA2) { return 0; }
+
+    int n = generator == 0xA2;
+    uint8_t control = regs[n ? SIM_TCB1_CTRLA : SIM_TCB0_CTRLA];
+    if (!(control & 0b00000001) || (regs[n ? SIM_TCB1_CTRLB : SIM_TCB0_CTRLB] & 0b00000111) != 0) { return 0; }
+
+    // CLKSEL (Bit 3:1) of DIV1 or DIV2
+    uint64_t prescaler = ((control >> 1) & 0b00000111) == 1 ? 2 : 1;
+
+    startAt = timerStartAt[n];
+    return prescaler * (regs[n ? SIM_TCB1_CCMP : SIM_TCB0_CCMP] + 1ULL);
+  }
+
+#elif SIM_SAMPNUM
+
+  // Conversions started by the event system are not modelled, the library does not use them
+  static uint64_t triggerPeriod(uint64_t& startAt)
+  {
+    (void)startAt;
+    return 0;
+  }
+
+#else
+
+  // CPU cycles between compare match B of Timer1 in CTC mode, 0 if not running
+  static uint64_t timer1Period(uint64_t& startAt)
+  {
+    static const uint16_t prescalers[] = {0, 1, 8, 64, 256, 1024};
+
+    uint8_t CS = regs[SIM_TCCR1B] & 0b00000111;
+    if (CS == 0 || CS > 5 || (regs[SIM_TCCR1B] & 0b00011000) != 0b00001000) { return 0; }
+
+    startAt = timerStartAt[1] + (uint64_t)prescalers[CS] * regs[SIM_OCR1B];
+    return (uint64_t)prescalers[CS] * (regs[SIM_OCR1A] + 1ULL);
+  }
+
+  // CPU cycles between triggers of the auto trigger source, 0 if it is not modelled
+  static uint64_t triggerPeriod(uint64_t& startAt)
+  {
+    if (!(regs[SIM_ADCSRA] & 0b00100000)) { return 0; }
+
+    switch (triggerSource())
+    {
+      // Timer0 overflow
+      case 4:
+        startAt = 0;
+        return SIM_TIMER0_OVERFLOW_CYCLES;
+
+      // Timer1 compare match B, only a rising edge of OCF1B (Bit 2) starts a conversion
+      case 5:
+        if (regs[SIM_TIFR1] & 0b00000100) { return 0; }
+        return timer1Period(startAt);
+
+      default:
+        return 0;
+    }
+  }
+
+#endif
+
+
+// Start the next conversion of a timer or event trigger, if any
+static void autoTrigger(uint64_t afterCycles)
+{
+  uint64_t startAt = 0;
+  uint64_t period = enabled() ? triggerPeriod(startAt) : 0;
+
+  // Turning the trigger off stops waiting for it
+  if (period == 0 && converting && startedAt > afterCycles)
+  {
+    converting = false;
+
+    #if SIM_TINY
+      regs[SIM_ADC0_STATUS] &= ~0b00000001;
+    #elif SIM_SAMPNUM
+      regs[SIM_ADC0_COMMAND] &= ~0b00000001;
+    #else
+      regs[SIM_ADCSRA] &= ~0b01000000;
+    #endif
+  }
+
+  if (converting || period == 0) { return; }
+
+  uint64_t triggerAt = nextPeriod(startAt, period, afterCycles);
+  startConversion(triggerAt);
+
+  // The compare match sets OCF1B, whether or not its interrupt is on
+  #if !SIM_TINY && !SIM_SAMPNUM
+    if (triggerSource() == 5) { regs[SIM_TIFR1] |= 0b00000100; }
+  #endif
+}
+
+
+/*================================================================================*/
+
+
+// Start a conversion at the given time
+static void startConversion(uint64_t atCycles)
+{
+  #if SIM_TINY
+
+    // MODE (Bit 6:4), SAMPNUM is only used by the series and burst modes (2 to 5),
+    // the single 8 and 12 bit modes (0 and 1) always take one sample
+    uint8_t  mode = (regs[SIM_ADC0_COMMAND] >> 4) & 0b00000111;
+    uint8_t  sampleNumber = mode >= 2 ? regs[SIM_ADC0_CTRLF] & 0b00001111 : 0;
+    if (sampleNumber > 10) { sampleNumber = 10; }
+
+    uint32_t samples = 1UL << sampleNumber;
+    uint64_t perSample = sampleCycles();
+    uint32_t sum = 0;
+
+    for (uint32_t i=0; i<samples; i++)
+    {
+      pendingSample = sample(atCycles + i * perSample);
+      sum += pendingSample;
+    }
+
+    switch (mode)
+    {
+      // 8 bit
+      case 0:
+        sum >>= 4;
+        break;
+
+      // Scaled to 16 bits
+      case 3:
+      case 5:
+        if (sampleNumber > 4) { sum >>= sampleNumber - 4; }
+        else { sum <<= 4 - sampleNumber; }
+        break;
+
+      default:
+        break;
+    }
+
+    pendingResult = sum;
+    doneAt = atCycles + samples * perSample;
+    regs[SIM_ADC0_STATUS] |= 0b00000001;
+
+  #elif SIM_SAMPNUM
+
+    // SAMPNUM (Bit 2:0), at most 64 samples, 128 on the AVR Dx
+    uint8_t  sampleNumber = regs[SIM_ADC0_CTRLB] & 0b00000111;
+
+    #if !defined(__AVR_AVR128DA48__)
+      if (sampleNumber > 6) { sampleNumber = 6; }
+    #endif
+
+    uint32_t samples = 1UL << sampleNumber;
+    uint64_t perSample = sampleCycles();
+    uint32_t sum = 0;
+
+    for (uint32_t i=0; i<samples; i++)
+    {
+      pendingSample = sample(atCycles + i * perSample);
+      sum += pendingSample;
+    }
+
+    // RES has 16 bits, the AVR Dx keeps the top 16 bits of a larger result
+    #if defined(__AVR_AVR128DA48__)
+      if (12 + sampleNumber > 16) { sum >>= 12 + sampleNumber - 16; }
+    #endif
+
+    pendingResult = sum;
+    doneAt = atCycles + samples * perSample;
+
+    // STCONV (Bit 0) reads 1 while converting
+    regs[SIM_ADC0_COMMAND] |= 0b00000001;
+
+  #else
+
+    // The first conversion after enabling the ADC takes 25 ADC clock cycles, else 13.
+    // The input is sampled 1.5 ADC clock cycles after the start.
+    uint64_t clock = clockCycles();
+
+    pendingResult = sample(atCycles + clock * 3 / 2);
+    pendingSample = pendingResult;
+    doneAt = atCycles + (firstConversion ? 25 : 13) * clock;
+    firstConversion = false;
+    regs[SIM_ADCSRA] |= 0b01000000;
+
+  #endif
+
+  startedAt = atCycles;
+  converting = true;
+}
+
+
+// Finish every conversion due by now, free running ones start the next one
+static void update()
+{
+  while (converting && doneAt <= cycles)
+  {
+    converting = false;
+    uint64_t finishedAt = doneAt;
+
+    #if SIM_TINY
+
+      regs[SIM_ADC0_RESULT] = pendingResult;
+      regs[SIM_ADC0_SAMPLE] = pendingSample;
+      regs[SIM_ADC0_STATUS] &= ~0b00000001;
+      regs[SIM_ADC0_INTFLAGS] |= 0b00000001;
+
+      if (windowMatched()) { regs[SIM_ADC0_INTFLAGS] |= 0b00000010; }
+
+      // FREERUN (Bit 5)
+      if (enabled() && (regs[SIM_ADC0_CTRLF] & 0b00100000)) { startConversion(finishedAt); }
+
+      autoTrigger(finishedAt);
+
+    #elif SIM_SAMPNUM
+
+      regs[SIM_ADC0_RES] = pendingResult;
+      regs[SIM_ADC0_COMMAND] &= ~0b00000001;
+      regs[SIM_ADC0_INTFLAGS] |= 0b00000001;
+
+      if (windowMatched()) { regs[SIM_ADC0_INTFLAGS] |= 0b00000010; }
+
+      // FREERUN (Bit 1)
+      if (enabled() && (regs[SIM_ADC0_CTRLA] & 0b00000010)) { startConversion(finishedAt); }
+
+    #else
+
+      regs[SIM_ADCL] = pendingResult & 0xFF;
+      regs[SIM_ADCH] = pendingResult >> 8;
+      regs[SIM_ADCSRA] &= ~0b01000000;
+      regs[SIM_ADCSRA] |= 0b00010000;
+
+      // ADATE (Bit 5) with ADTS cleared is free running
+      if (enabled() && (regs[SIM_ADCSRA] & 0b00100000) && triggerSource() == 0)
+      {
+        startConversion(finishedAt);
+      }
+
+      autoTrigger(finishedAt);
+
+    #endif
+  }
+}
+
+
+// Call the ADC interrupt if it is enabled and due
+static void takeInterrupts()
+{
+  if (inISR || !(regs[SIM_SREG] & 0b10000000)) { return; }
+
+  #if SIM_TINY
+
+    // Window compare first, it has the higher priority
+    bool window = (regs[SIM_ADC0_INTCTRL] & regs[SIM_ADC0_INTFLAGS] & 0b00000010) && ADC0_WCMP_vect != NULL;
+
+    if (!window && (!(regs[SIM_ADC0_INTCTRL] & regs[SIM_ADC0_INTFLAGS] & 0b00000001) || ADC0_RESRDY_vect == NULL)) { return; }
+
+  #elif SIM_SAMPNUM
+
+    // Window compare first, it has the higher priority
+    bool window = (regs[SIM_ADC0_INTCTRL] & regs[SIM_ADC0_INTFLAGS] & 0b00000010) && SIM_WINDOW_VECT != NULL;
+
+    if (!window && (!(regs[SIM_ADC0_INTCTRL] & regs[SIM_ADC0_INTFLAGS] & 0b00000001) || ADC0_RESRDY_vect == NULL)) { return; }
+
+  #else
+
+    if ((regs[SIM_ADCSRA] & 0b00011000) != 0b00011000 || ADC_vect == NULL) { return; }
+
+    // ADIF is cleared when the interrupt is taken
+    regs[SIM_ADCSRA] &= ~0b00010000;
+
+  #endif
+
+  // Interrupts are disabled inside the ISR, reti enables them again
+  inISR = true;
+  regs[SIM_SREG] &= ~0b10000000;
+
+  #if SIM_TINY
+    if (window) { ADC0_WCMP_vect(); }
+    else { ADC0_RESRDY_vect(); }
+  #elif SIM_SAMPNUM
+    if (window) { SIM_WINDOW_VECT(); }
+    else { ADC0_RESRDY_vect(); }
+  #else
+    ADC_vect();
+  #endif
+
+  regs[SIM_SREG] |= 0b10000000;
+  inISR = false;
+}
+
+
+/*================================================================================*/
+
+
+uint32_t simRead(SimRegisterID id)
+{
+  cycles += SIM_ACCESS_CYCLES;
+  update();
+
+  uint32_t value = regs[id];
+
+  #if SIM_TINY
+
+    // Reading the result clears the result ready flag
+    if (id == SIM_ADC0_RESULT) { regs[SIM_ADC0_INTFLAGS] &= ~0b00000001; }
+
+  #elif SIM_SAMPNUM
+
+    // Reading the result clears the result ready flag
+    if (id == SIM_ADC0_RES) { regs[SIM_ADC0_INTFLAGS] &= ~0b00000001; }
+
+  #endif
+
+  return value;
+}
+
+
+void simWrite(SimRegisterID id, uint32_t value)
+{
+  cycles += SIM_ACCESS_CYCLES;
+  update();
+
+  double previousInput = inputmV(cycles);
+
+  #if !SIM_TINY && !SIM_SAMPNUM
+    bool wasEnabled = enabled();
+  #endif
+
+  switch (id)
+  {
+    case SIM_SREG:
+      regs[id] = value;
+      takeInterrupts();
+      return;
+
+  #if SIM_TINY
+
+    case SIM_ADC0_COMMAND:
+      // START (Bit 2:0) of 1 starts a conversion, it reads back as 0.
+      // START of 4 starts one on every event, it stays.
+      // START of 0 (STOP) throws away the conversion in progress.
+      regs[id] = value & ((value & 0b00000111) == 4 ? 0b11111111 : 0b11111000);
+      if ((value & 0b00000111) == 1 && enabled() && !converting) { startConversion(cycles); }
+
+      if ((value & 0b00000111) == 0 && converting)
+      {
+        converting = false;
+        regs[SIM_ADC0_STATUS] &= ~0b00000001;
+      }
+      break;
+
+    case SIM_ADC0_INTFLAGS:
+      // Writing 1 clears a flag
+      regs[id] &= ~value;
+      break;
+
+    case SIM_ADC0_STATUS:
+    case SIM_ADC0_RESULT:
+    case SIM_ADC0_SAMPLE:
+      // Read only
+      break;
+
+    case SIM_TCB0_CTRLA:
+    case SIM_TCB0_CNT:
+      regs[id] = value;
+      timerStartAt[0] = cycles;
+      break;
+
+    case SIM_TCB1_CTRLA:
+    case SIM_TCB1_CNT:
+      regs[id] = value;
+      timerStartAt[1] = cycles;
+      break;
+
+  #elif SIM_SAMPNUM
+
+    case SIM_ADC0_COMMAND:
+      // STCONV (Bit 0) starts a conversion, it reads 1 until the conversion is done
+      if ((value & 0b00000001) && enabled() && !converting) { startConversion(cycles); }
+      break;
+
+    case SIM_ADC0_INTFLAGS:
+      // Writing 1 clears a flag
+      regs[id] &= ~value;
+      break;
+
+    case SIM_ADC0_RES:
+      // Read only
+      break;
+
+  #else
+
+    case SIM_ADCSRA:
+    {
+      // Writing 1 to ADIF (Bit 4) clears it, ADSC (Bit 6) stays 1 until the conversion is done
+      uint8_t flags = (regs[id] & ~value & 0b00010000) | (regs[id] & 0b01000000);
+      regs[id] = (value & 0b10101111) | flags;
+
+      if (!wasEnabled && enabled()) { firstConversion = true; }
+      if ((value & 0b01000000) && enabled() && !converting) { startConversion(cycles); }
+      break;
+    }
+
+    case SIM_ADCL:
+    case SIM_ADCH:
+      // Read only
+      break;
+
+    case SIM_TIFR1:
+      // Writing 1 clears a flag
+      regs[id] &= ~value;
+      break;
+
+    case SIM_TCCR1B:
+    case SIM_TCNT1:
+      regs[id] = value;
+      timerStartAt[1] = cycles;
+      break;
+
+  #endif
+
+    default:
+      regs[id] = value;
+      break;
+  }
+
+  // Turning the ADC off stops the conversion
+  if (!enabled()) { converting = false; }
+
+  // Auto trigger may have been turned on or off
+  autoTrigger(cycles);
+
+  checkSwitch(previousInput);
+}
+
+
+/*================================================================================*/
+
+
+void simAdvance(uint64_t moreCycles)
+{
+  uint64_t target = cycles + moreCycles;
+
+  // Stop at every conversion on the way, so interrupts come at the right time
+  while (converting && doneAt <= target)
+  {
+    cycles = doneAt;
+    update();
+    takeInterrupts();
+  }
+
+  cycles = target;
+  update();
+  takeInterrupts();
+}
+
+
+void sleep_cpu()
+{
+  // Nothing can wake the CPU with interrupts disabled, do not hang
+  if (!(regs[SIM_SREG] & 0b10000000)) { return; }
+
+  if (converting) { simAdvance(doneAt > cycles ? doneAt - cycles : 0); }
+  else { simAdvance(F_CPU / 1000000UL); }
+}
+
+
+unsigned long micros()
+{
+  simAdvance(SIM_ACCESS_CYCLES);
+  return cycles * 1000000ULL / F_CPU;
+}
+
+
+unsigned long millis()
+{
+  simAdvance(SIM_ACCESS_CYCLES);
+  return cycles * 1000ULL / F_CPU;
+}
+
+
+void delay(unsigned long ms)
+{
+  simAdvance((uint64_t)ms * (F_CPU / 1000UL));
+}
+
+
+void delayMicroseconds(unsigned int us)
+{
+  simAdvance((uint64_t)us * (F_CPU / 1000000UL));
+}
+
+
+/*================================================================================*/
+
+
+int analogRead(uint8_t pin)
+{
+  #if SIM_TINY
+
+    ADC0.MUXPOS = pin & 0b00001111;
+    ADC0.COMMAND = 0b00010001; // Single 12 bit, start
+    while (ADC0.STATUS & 0b00000001) {}
+    return ADC0.RESULT;
+
+  #elif SIM_SAMPNUM
+
+    ADC0.MUXPOS = pin & 0b00011111;
+    ADC0.CTRLB = 0b00000000; // Single sample
+    ADC0.COMMAND = 0b00000001;
+    while (ADC0.COMMAND & 0b00000001) {}
+    return ADC0.RES;
+
+  #else
+
+    // Pin numbers from A0 are taken as channels
+    if (pin >= A0) { pin -= A0; }
+
+    ADMUX = (analogReferenceMode << 6) | (pin & 0b00000111);
+    ADCSRA |= 0b01000000;
+    while (ADCSRA & 0b01000000) {}
+
+    uint8_t low = ADCL;
+    return low | (ADCH << 8);
+
+  #endif
+}
+
+
+void analogReference(uint8_t mode)
+{
+  analogReferenceMode = mode;
+
+  #if SIM_TINY
+    ADC0.CTRLC = (ADC0.CTRLC & 0b11111000) | (mode & 0b00000111);
+  #elif SIM_SAMPNUM && defined(__AVR_AVR128DA48__)
+    VREF.ADC0REF = (VREF.ADC0REF & 0b11111000) | (mode & 0b00000111);
+  #elif SIM_SAMPNUM
+    ADC0.CTRLC = (ADC0.CTRLC & 0b11001111) | ((mode & 0b00000011) << 4);
+  #endif
+}
+
+
+/*================================================================================*/
+
+
+void simSetVcc(double mV) { vccmV = mV; }
+
+void simSetVccWaveform(double (*waveform)(double seconds)) { vccWaveform = waveform; }
+
+void simSetVccRipple(double amplitudemV, double hz)
+{
+  rippleAmplitude = amplitudemV;
+  rippleHz = hz;
+}
+
+double simGetVcc() { return simGetVccAt(cycles); }
+
+void simSetBandgap(double mV) { bandgapmV = mV; }
+
+void simSetTemperature(double myCelsius) { celsius = myCelsius; }
+
+void simSetBandgapTempco(double ppmPerC) { bandgapTempco = ppmPerC; }
+
+void simSetSettlingTime(double myTauMicros) { tauMicros = myTauMicros; }
+
+void simSetNoise(double stepsRMS) { noiseRMS = stepsRMS; }
+
+void simSetSeed(uint32_t seed) { randomState = seed != 0 ? seed : 1; }
+
+void simSetPin(uint8_t ch, double mV) { if (ch < 16) { pinmV[ch] = mV; } }
+
+uint64_t simGetCycles() { return cycles; }
+
+uint32_t simGetConversions() { return conversions; }
+
+
+// EEPROM, kept inverted so it starts out erased (0xFF) before any constructor runs
+static uint8_t eepromInverted[E2END + 1];
+
+void eeprom_read_block(void* destination, const void* source, size_t size)
+{
+  size_t address = (size_t)source;
+
+  for (size_t i=0; i<size && address+i <= E2END; i++)
+  {
+    ((uint8_t*)destination)[i] = ~eepromInverted[address+i];
+  }
+}
+
+void eeprom_update_block(const void* source, void* destination, size_t size)
+{
+  size_t address = (size_t)destination;
+
+  for (size_t i=0; i<size && address+i <= E2END; i++)
+  {
+    eepromInverted[address+i] = ~((const uint8_t*)source)[i];
+  }
+}
+
+void simEraseEEPROM() { memset(eepromInverted, 0, sizeof(eepromInverted)); }
+
+
+// Power on, then what the Arduino core does in init()
+void simReset()
+{
+  memset(regs, 0, sizeof(regs));
+  cycles = 0;
+  converting = false;
+  firstConversion = true;
+  conversions = 0;
+  vccmV = 5000;
+  vccWaveform = NULL;
+  rippleAmplitude = 0;
+  rippleHz = 0;
+  bandgapmV = defaultBandgap;
+  celsius = 25;
+  bandgapTempco = 0;
+  tauMicros = defaultTau;
+  noiseRMS = 0.5;
+  randomState = 1;
+  inISR = false;
+  analogReferenceMode = DEFAULT;
+  timerStartAt[0] = 0;
+  timerStartAt[1] = 0;
+  for (int i=0; i<16; i++) { pinmV[i] = 0; }
+
+  // Interrupts enabled
+  regs[SIM_SREG] = 0b10000000;
+
+  #if SIM_TINY
+
+    // ADC on, CLK_ADC at 1MHz for 16MHz, VDD reference, single 12 bit
+    regs[SIM_ADC0_CTRLA] = 0b00000001;
+    regs[SIM_ADC0_CTRLB] = 7;
+    regs[SIM_ADC0_CTRLC] = 16 << 3;
+    regs[SIM_ADC0_COMMAND] = 0b00010000;
+
+  #elif SIM_SAMPNUM && defined(__AVR_AVR128DA48__)
+
+    // ADC on, CLK_ADC at 1MHz for 16MHz, VDD reference
+    regs[SIM_ADC0_CTRLA] = 0b00000001;
+    regs[SIM_ADC0_CTRLC] = 0b00000100;
+    regs[SIM_VREF_ADC0REF] = 0b00000101;
+
+  #elif SIM_SAMPNUM
+
+    // ADC on, CLK_ADC at 1MHz for 16MHz, VDD reference with the smaller sample capacitor
+    regs[SIM_ADC0_CTRLA] = 0b00000001;
+    regs[SIM_ADC0_CTRLC] = 0b01010011;
+
+  #else
+
+    // ADC on, divide by 128
+    regs[SIM_ADCSRA] = 0b10000111;
+
+  #endif
+
+  lastChannel = enabled() ? channel() : 0xFF;
+  switchAt = 0;
+  switchFrom = 0;
+}
+
+
+// Registers start out as after simReset()
+static struct SimPowerOn { SimPowerOn() { simReset(); } } simPowerOn;
@@ -0,0 +1,143 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation Header */
+
+/*
+ * Lets the library compile and run on a PC with g++. The ADC registers used by
+ * the library (ADMUX, ADCSRA, ADC0.CTRLF...) are objects that behave like the
+ * registers of the ATmega, the ATtiny3224/3226/3227, the tinyAVR 0/1-series, the
+ * megaAVR 0-series or the AVR Dx, picked by defining __AVR_ATmega328P__,
+ * __AVR_ATmega32U4__, __AVR_ATmega2560__, __AVR_ATtiny3224__, __AVR_ATtiny1614__,
+ * __AVR_ATmega4809__ or __AVR_AVR128DA48__.
+ *
+ * Time only moves when the ADC is busy-waited on, when the CPU sleeps, or when
+ * micros(), millis(), delay() or delayMicroseconds() are called. Interrupts are
+ * only taken at those points, or when they are enabled with sei().
+ *
+ * Everything here is for the host build only, the library does not use it.
+ */
+
+
+#ifndef MCUVOLTAGESIM_H
+#define MCUVOLTAGESIM_H
+
+#include <stdint.h>
+
+
+// Every register the simulation knows of
+enum SimRegisterID
+{
+  SIM_SREG,
+
+  // ATmega
+  SIM_ADMUX, SIM_ADCSRA, SIM_ADCSRB, SIM_ADCL, SIM_ADCH,
+  SIM_TCCR1A, SIM_TCCR1B, SIM_TCNT1, SIM_OCR1A, SIM_OCR1B, SIM_TIFR1,
+
+  // ATtiny3224/3226/3227
+  SIM_ADC0_CTRLA, SIM_ADC0_CTRLB, SIM_ADC0_CTRLC, SIM_ADC0_CTRLD, SIM_ADC0_CTRLE, SIM_ADC0_CTRLF,
+  SIM_ADC0_COMMAND, SIM_ADC0_PGACTRL, SIM_ADC0_MUXPOS, SIM_ADC0_MUXNEG,
+  SIM_ADC0_INTCTRL, SIM_ADC0_INTFLAGS, SIM_ADC0_STATUS, SIM_ADC0_DBGCTRL,
+  SIM_ADC0_RESULT, SIM_ADC0_SAMPLE, SIM_ADC0_WINLT, SIM_ADC0_WINHT,
+  SIM_VREF_CTRLA, SIM_VREF_CTRLB, SIM_AC0_DACREF,
+  SIM_TCB0_CTRLA, SIM_TCB0_CTRLB, SIM_TCB0_CNT, SIM_TCB0_CCMP,
+  SIM_TCB1_CTRLA, SIM_TCB1_CTRLB, SIM_TCB1_CNT, SIM_TCB1_CCMP,
+  SIM_EVSYS_CHANNEL0, SIM_EVSYS_CHANNEL1, SIM_EVSYS_CHANNEL2, SIM_EVSYS_CHANNEL3,
+  SIM_EVSYS_CHANNEL4, SIM_EVSYS_CHANNEL5, SIM_EVSYS_USERADC0START,
+
+  // tinyAVR 0/1-series, megaAVR 0-series and AVR Dx, on top of the ADC0 ones above
+  SIM_ADC0_SAMPCTRL, SIM_ADC0_EVCTRL, SIM_ADC0_RES,
+  SIM_VREF_ADC0REF, SIM_VREF_ACREF,
+
+  SIM_REGISTER_COUNT
+};
+
+
+// Register access, every read and write goes through the ADC model
+uint32_t simRead(SimRegisterID id);
+void     simWrite(SimRegisterID id, uint32_t value);
+
+
+// Looks like a volatile register of type T to the library
+template <typename T>
+class SimRegister
+{
+  public:
+
+    explicit SimRegister(SimRegisterID myID) : id(myID) {}
+
+    operator T() const { return (T)simRead(id); }
+
+    SimRegister& operator=(T value) { simWrite(id, value); return *this; }
+    SimRegister& operator|=(T value) { simWrite(id, (T)simRead(id) | value); return *this; }
+    SimRegister& operator&=(T value) { simWrite(id, (T)simRead(id) & value); return *this; }
+    SimRegister& operator^=(T value) { simWrite(id, (T)simRead(id) ^ value); return *this; }
+
+  private:
+
+    // Registers cannot be copied, only read and written
+    SimRegister(const SimRegister&);
+    SimRegister& operator=(const SimRegister&);
+
+    SimRegisterID id;
+};
+
+
+/*================================================================================*/
+
+
+// Vcc in millivolts, constant
+void     simSetVcc(double mV);
+
+// Vcc in millivolts as a function of the simulated time in seconds, NULL to go back to constant
+void     simSetVccWaveform(double (*waveform)(double seconds));
+
+// Sine ripple added on top of Vcc
+void     simSetVccRipple(double amplitudemV, double hz);
+
+// Vcc in millivolts right now
+double   simGetVcc();
+
+// True bandgap (ATmega) or VREF (ATtiny) voltage in millivolts, may differ from what the library assumes
+void     simSetBandgap(double mV);
+
+// Temperature of the chip in degrees Celsius, read by the temperature sensor, 25 at start
+void     simSetTemperature(double celsius);
+
+// How much the bandgap moves with temperature, in parts per million per degree away from 25, 0 at start
+void     simSetBandgapTempco(double ppmPerC);
+
+// Time constant of the bandgap settling after the mux switches to it, in microseconds
+void     simSetSettlingTime(double tauMicros);
+
+// Standard deviation of the noise added to every sample, in ADC steps
+void     simSetNoise(double stepsRMS);
+
+// Seed of the noise, same seed gives the same readings
+void     simSetSeed(uint32_t seed);
+
+// Voltage on an analog channel in millivolts, for analogRead()
+void     simSetPin(uint8_t channel, double mV);
+
+// Simulated CPU cycles since start
+uint64_t simGetCycles();
+
+// Number of single conversions (samples) the ADC has done
+uint32_t simGetConversions();
+
+// Move time forward, taking any interrupts that become due
+void     simAdvance(uint64_t cycles);
+
+// Put the ADC model, time and settings back to power on
+void     simReset();
+
+// Erase the EEPROM to 0xFF, simReset() keeps it like a real reset does
+void     simEraseEEPROM();
+
+#endif
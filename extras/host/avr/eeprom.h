@@ -0,0 +1,18 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: EEPROM */
+
+
+#ifndef MCUVOLTAGESIM_EEPROM_H
+#define MCUVOLTAGESIM_EEPROM_H
+
+#include <stddef.h>
+#include <avr/io.h>
+
+// Kept in MCUVoltageSim.cpp, E2END+1 bytes, erased (0xFF) at start and not cleared by simReset()
+void eeprom_read_block(void* destination, const void* source, size_t size);
+void eeprom_update_block(const void* source, void* destination, size_t size);
+
+#endif
@@ -0,0 +1,20 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Interrupts */
+
+
+#ifndef MCUVOLTAGESIM_INTERRUPT_H
+#define MCUVOLTAGESIM_INTERRUPT_H
+
+#include <avr/io.h>
+
+// The simulation calls the vector when the interrupt is due
+#define ISR(vector) extern "C" void vector(void)
+
+// Clear and set the global interrupt enable (Bit 7 of SREG)
+inline void cli() { SREG &= 0b01111111; }
+inline void sei() { SREG |= 0b10000000; }
+
+#endif
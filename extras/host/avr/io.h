@@ -0,0 +1,187 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: ADC Registers */
+
+
+#ifndef MCUVOLTAGESIM_IO_H
+#define MCUVOLTAGESIM_IO_H
+
+#include <MCUVoltageSim.h>
+
+extern SimRegister<uint8_t> SREG;
+
+// Last EEPROM address, as in the real io.h
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || \
+    defined(__AVR_ATtiny1614__) || defined(__AVR_ATmega4809__)
+  #define E2END 0xFF
+#elif defined(__AVR_AVR128DA48__)
+  #define E2END 0x1FF
+#elif defined(__AVR_ATmega2560__)
+  #define E2END 0xFFF
+#else
+  #define E2END 0x3FF
+#endif
+
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  struct SimADC
+  {
+    SimRegister<uint8_t>  CTRLA{SIM_ADC0_CTRLA};
+    SimRegister<uint8_t>  CTRLB{SIM_ADC0_CTRLB};
+    SimRegister<uint8_t>  CTRLC{SIM_ADC0_CTRLC};
+    SimRegister<uint8_t>  CTRLD{SIM_ADC0_CTRLD};
+    SimRegister<uint8_t>  CTRLE{SIM_ADC0_CTRLE};
+    SimRegister<uint8_t>  CTRLF{SIM_ADC0_CTRLF};
+    SimRegister<uint8_t>  COMMAND{SIM_ADC0_COMMAND};
+    SimRegister<uint8_t>  PGACTRL{SIM_ADC0_PGACTRL};
+    SimRegister<uint8_t>  MUXPOS{SIM_ADC0_MUXPOS};
+    SimRegister<uint8_t>  MUXNEG{SIM_ADC0_MUXNEG};
+    SimRegister<uint8_t>  INTCTRL{SIM_ADC0_INTCTRL};
+    SimRegister<uint8_t>  INTFLAGS{SIM_ADC0_INTFLAGS};
+    SimRegister<uint8_t>  STATUS{SIM_ADC0_STATUS};
+    SimRegister<uint8_t>  DBGCTRL{SIM_ADC0_DBGCTRL};
+    SimRegister<uint32_t> RESULT{SIM_ADC0_RESULT};
+    SimRegister<uint16_t> SAMPLE{SIM_ADC0_SAMPLE};
+    SimRegister<uint16_t> WINLT{SIM_ADC0_WINLT};
+    SimRegister<uint16_t> WINHT{SIM_ADC0_WINHT};
+  };
+
+  struct SimVREF
+  {
+    SimRegister<uint8_t> CTRLA{SIM_VREF_CTRLA};
+    SimRegister<uint8_t> CTRLB{SIM_VREF_CTRLB};
+  };
+
+  struct SimAC
+  {
+    SimRegister<uint8_t> DACREF{SIM_AC0_DACREF};
+  };
+
+  struct SimTCB
+  {
+    explicit SimTCB(int n) :
+      CTRLA(n ? SIM_TCB1_CTRLA : SIM_TCB0_CTRLA),
+      CTRLB(n ? SIM_TCB1_CTRLB : SIM_TCB0_CTRLB),
+      CNT(n ? SIM_TCB1_CNT : SIM_TCB0_CNT),
+      CCMP(n ? SIM_TCB1_CCMP : SIM_TCB0_CCMP) {}
+
+    SimRegister<uint8_t>  CTRLA;
+    SimRegister<uint8_t>  CTRLB;
+    SimRegister<uint16_t> CNT;
+    SimRegister<uint16_t> CCMP;
+  };
+
+  struct SimEVSYS
+  {
+    SimRegister<uint8_t> CHANNEL0{SIM_EVSYS_CHANNEL0};
+    SimRegister<uint8_t> CHANNEL1{SIM_EVSYS_CHANNEL1};
+    SimRegister<uint8_t> CHANNEL2{SIM_EVSYS_CHANNEL2};
+    SimRegister<uint8_t> CHANNEL3{SIM_EVSYS_CHANNEL3};
+    SimRegister<uint8_t> CHANNEL4{SIM_EVSYS_CHANNEL4};
+    SimRegister<uint8_t> CHANNEL5{SIM_EVSYS_CHANNEL5};
+    SimRegister<uint8_t> USERADC0START{SIM_EVSYS_USERADC0START};
+  };
+
+  // Factory calibration of the temperature sensor, made up values that the model follows
+  struct SimSIGROW
+  {
+    uint16_t TEMPSENSE0; // Gain
+    uint16_t TEMPSENSE1; // Offset
+  };
+
+  extern SimADC   ADC0;
+  extern SimVREF  VREF;
+  extern SimAC    AC0;
+  extern SimTCB   TCB0;
+  extern SimTCB   TCB1;
+  extern SimEVSYS EVSYS;
+  extern const SimSIGROW SIGROW;
+
+#elif defined(__AVR_ATtiny1614__) || defined(__AVR_ATmega4809__) || defined(__AVR_AVR128DA48__)
+
+  // Masks and register names the library picks the ADC by, as in the real io.h
+  #define ADC_STCONV_bm  0x01
+  #define ADC_SAMPNUM_gm 0x07
+
+  #if defined(__AVR_AVR128DA48__)
+    #define VREF_ADC0REF       VREF.ADC0REF
+    #define AC0_DACREF         AC0.DACREF
+    #define ADC0_WCMP_vect_num 27
+  #elif defined(__AVR_ATmega4809__)
+    #define AC0_DACREF          AC0.DACREF
+    #define ADC0_WCOMP_vect_num 23
+  #else
+    #define ADC0_WCOMP_vect_num 17
+  #endif
+
+  struct SimADC
+  {
+    SimRegister<uint8_t>  CTRLA{SIM_ADC0_CTRLA};
+    SimRegister<uint8_t>  CTRLB{SIM_ADC0_CTRLB};
+    SimRegister<uint8_t>  CTRLC{SIM_ADC0_CTRLC};
+    SimRegister<uint8_t>  CTRLD{SIM_ADC0_CTRLD};
+    SimRegister<uint8_t>  CTRLE{SIM_ADC0_CTRLE};
+    SimRegister<uint8_t>  SAMPCTRL{SIM_ADC0_SAMPCTRL};
+    SimRegister<uint8_t>  MUXPOS{SIM_ADC0_MUXPOS};
+    SimRegister<uint8_t>  COMMAND{SIM_ADC0_COMMAND};
+    SimRegister<uint8_t>  EVCTRL{SIM_ADC0_EVCTRL};
+    SimRegister<uint8_t>  INTCTRL{SIM_ADC0_INTCTRL};
+    SimRegister<uint8_t>  INTFLAGS{SIM_ADC0_INTFLAGS};
+    SimRegister<uint8_t>  DBGCTRL{SIM_ADC0_DBGCTRL};
+    SimRegister<uint16_t> RES{SIM_ADC0_RES};
+    SimRegister<uint16_t> WINLT{SIM_ADC0_WINLT};
+    SimRegister<uint16_t> WINHT{SIM_ADC0_WINHT};
+  };
+
+  struct SimVREF
+  {
+    #if defined(__AVR_AVR128DA48__)
+      SimRegister<uint8_t> ADC0REF{SIM_VREF_ADC0REF};
+      SimRegister<uint8_t> ACREF{SIM_VREF_ACREF};
+    #else
+      SimRegister<uint8_t> CTRLA{SIM_VREF_CTRLA};
+      SimRegister<uint8_t> CTRLB{SIM_VREF_CTRLB};
+    #endif
+  };
+
+  struct SimAC
+  {
+    SimRegister<uint8_t> DACREF{SIM_AC0_DACREF};
+  };
+
+  // Factory calibration of the temperature sensor, made up values that the model follows
+  struct SimSIGROW
+  {
+    uint16_t TEMPSENSE0; // Gain
+    uint16_t TEMPSENSE1; // Offset
+  };
+
+  extern SimADC   ADC0;
+  extern SimVREF  VREF;
+  extern const SimSIGROW SIGROW;
+
+  #if defined(AC0_DACREF)
+    extern SimAC  AC0;
+  #endif
+
+#else
+
+  extern SimRegister<uint8_t> ADMUX;
+  extern SimRegister<uint8_t> ADCSRA;
+  extern SimRegister<uint8_t> ADCSRB;
+  extern SimRegister<uint8_t> ADCL;
+  extern SimRegister<uint8_t> ADCH;
+
+  // Timer1, only as far as it starts the ADC
+  extern SimRegister<uint8_t>  TCCR1A;
+  extern SimRegister<uint8_t>  TCCR1B;
+  extern SimRegister<uint16_t> TCNT1;
+  extern SimRegister<uint16_t> OCR1A;
+  extern SimRegister<uint16_t> OCR1B;
+  extern SimRegister<uint8_t>  TIFR1;
+
+#endif
+
+#endif
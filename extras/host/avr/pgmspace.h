@@ -0,0 +1,19 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Program Memory */
+
+
+#ifndef MCUVOLTAGESIM_PGMSPACE_H
+#define MCUVOLTAGESIM_PGMSPACE_H
+
+#include <stdint.h>
+
+// There is only one memory on the host
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const uint8_t*)(address))
+#define pgm_read_word(address)  (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+#endif
@@ -0,0 +1,21 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Sleep */
+
+
+#ifndef MCUVOLTAGESIM_SLEEP_H
+#define MCUVOLTAGESIM_SLEEP_H
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC  1
+
+inline void set_sleep_mode(int) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+
+// Sleeps until the next interrupt
+void sleep_cpu();
+
+#endif
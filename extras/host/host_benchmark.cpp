@@ -0,0 +1,163 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Benchmark */
+
+/*
+ * Runs every read path for a range of bit depths and averaging times on the
+ * simulated ADC, and prints one CSV line each, in the same columns as the
+ * example Benchmark_Read_Paths prints on a board:
+ *
+ *   device,api,bits,avg,cycles,us,conversions,mV
+ *
+ * cycles and us are the simulated time taken, which is the ADC time plus
+ * a few cycles for every register access. The CPU time spent on the math is
+ * not simulated, measure that on a board. Every path is run once before it
+ * is measured, so the setup and bandgap settling are not counted.
+ */
+
+
+#include <MCUVoltage.h>
+#include <stdio.h>
+
+
+MCUVoltage Vcc;
+
+
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+  #define DEVICE_NAME "ATtiny3224"
+#elif defined(__AVR_ATtiny1614__)
+  #define DEVICE_NAME "ATtiny1614"
+#elif defined(__AVR_ATmega4809__)
+  #define DEVICE_NAME "ATmega4809"
+#elif defined(__AVR_AVR128DA48__)
+  #define DEVICE_NAME "AVR128DA48"
+#elif defined(__AVR_ATmega32U4__)
+  #define DEVICE_NAME "ATmega32U4"
+#elif defined(__AVR_ATmega2560__)
+  #define DEVICE_NAME "ATmega2560"
+#else
+  #define DEVICE_NAME "ATmega328P"
+#endif
+
+
+enum BenchmarkAPI
+{
+  READMV, READMV_AVG, READ_AVG, READMV_OS, READMV_OS_AVG, READ_OS_AVG,
+  READMV_HWOS, READMV_HWOS_AVG, READ_HWOS_AVG, READMV_T
+};
+
+static const char* apiNames[] =
+{
+  "readmV", "readmV_avg", "read_avg", "readmV_OS", "readmV_OS_avg", "read_OS_avg",
+  "readmV_HWOS", "readmV_HWOS_avg", "read_HWOS_avg", "MCUVoltageT_readmV"
+};
+
+
+// One call of the path, returns Vcc in millivolts
+static unsigned long run(BenchmarkAPI api, byte bits, byte avg)
+{
+  switch (api)
+  {
+    case READMV:        return Vcc.readmV();
+    case READMV_AVG:    return Vcc.readmV(avg);
+    case READ_AVG:      return Vcc.read(avg) * 1000 + 0.5;
+    case READMV_OS:     return Vcc.readmV_OS(bits);
+    case READMV_OS_AVG: return Vcc.readmV_OS(bits, avg);
+    case READ_OS_AVG:   return Vcc.read_OS(bits, avg) * 1000 + 0.5;
+
+    #if MCUVOLTAGE_HWOS
+      case READMV_HWOS:     return Vcc.readmV_HWOS(bits);
+      case READMV_HWOS_AVG: return Vcc.readmV_HWOS(bits, avg);
+      case READ_HWOS_AVG:   return Vcc.read_HWOS(bits, avg) * 1000 + 0.5;
+    #endif
+
+    // The template needs constants, one oversampled and averaged case is enough
+    case READMV_T:      return MCUVoltageT<MCUVOLTAGE_BIT_DEPTH + 2, 4>::readmV();
+
+    default:            return 0;
+  }
+}
+
+
+static void measure(BenchmarkAPI api, byte bits, byte avg)
+{
+  // Warm up, so the setup and settling are not counted
+  run(api, bits, avg);
+
+  uint64_t startCycles = simGetCycles();
+  uint32_t startConversions = simGetConversions();
+
+  unsigned long mV = run(api, bits, avg);
+
+  uint64_t elapsed = simGetCycles() - startCycles;
+
+  printf("%s,%s,%u,%u,%llu,%.1f,%u,%lu\n",
+         DEVICE_NAME, apiNames[api], bits, avg,
+         (unsigned long long)elapsed, elapsed * 1e6 / F_CPU,
+         (unsigned)(simGetConversions() - startConversions), mV);
+}
+
+
+int main()
+{
+  static const byte avgs[] = {1, 4, 16, 64};
+  const byte nativeBits = MCUVOLTAGE_BIT_DEPTH;
+
+  simSetVcc(3300);
+  simSetNoise(0.7);
+
+  printf("device,api,bits,avg,cycles,us,conversions,mV\n");
+
+  measure(READMV, nativeBits, 1);
+
+  for (byte a=0; a<sizeof(avgs); a++)
+  {
+    measure(READMV_AVG, nativeBits, avgs[a]);
+    measure(READ_AVG, nativeBits, avgs[a]);
+  }
+
+  // Up to 6 extra bits, past that one reading takes 4^7 conversions
+  for (byte bits=nativeBits+1; bits<=nativeBits+6; bits++)
+  {
+    measure(READMV_OS, bits, 1);
+
+    for (byte a=0; a<sizeof(avgs); a++)
+    {
+      measure(READMV_OS_AVG, bits, avgs[a]);
+      measure(READ_OS_AVG, bits, avgs[a]);
+    }
+  }
+
+  #if MCUVOLTAGE_HWOS
+
+    // 13 to 17 bits on the ATtiny3224/3226/3227, 1 to 3 extra bits on the others
+    #if MCUVOLTAGE_SAMPNUM_ADC
+      const byte minBits = MCUVOLTAGE_BIT_DEPTH + 1, maxBits = MCUVOLTAGE_BIT_DEPTH + 3;
+    #else
+      const byte minBits = 13, maxBits = 17;
+    #endif
+
+    for (byte bits=minBits; bits<=maxBits; bits++)
+    {
+      measure(READMV_HWOS, bits, 1);
+
+      for (byte a=0; a<sizeof(avgs); a++)
+      {
+        measure(READMV_HWOS_AVG, bits, avgs[a]);
+        measure(READ_HWOS_AVG, bits, avgs[a]);
+      }
+    }
+
+  #endif
+
+  measure(READMV_T, nativeBits + 2, 4);
+
+  return 0;
+}
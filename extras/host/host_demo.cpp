@@ -0,0 +1,115 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Demo */
+
+/*
+ * Reads a simulated Vcc with the blocking, non-blocking and time sliced
+ * readings, and prints what was read against the simulated Vcc, with the
+ * conversions and simulated time taken. See "Extra: Host Simulation" in the readme.
+ */
+
+
+#include <MCUVoltage.h>
+#include <stdio.h>
+
+
+MCUVoltage Vcc;
+
+
+// Print one result with what it cost since the last call
+static void report(const char* name, unsigned long mV)
+{
+  static uint64_t  lastCycles = 0;
+  static uint32_t  lastConversions = 0;
+
+  printf("%-28s %5lu mV (Vcc %6.1f mV)  %6u conversions  %9.1f us\n",
+         name, mV, simGetVcc(),
+         (unsigned)(simGetConversions() - lastConversions),
+         (simGetCycles() - lastCycles) * 1e6 / F_CPU);
+
+  lastCycles = simGetCycles();
+  lastConversions = simGetConversions();
+}
+
+
+// Vcc of a battery slowly running down
+static double fallingVcc(double seconds)
+{
+  return 4200 - 100 * seconds;
+}
+
+
+int main()
+{
+  simSetVcc(3300);
+  simSetNoise(0.7);
+  report("start", 0);
+
+  report("readmV()", Vcc.readmV());
+  report("readmV(8)", Vcc.readmV(8));
+  report("readmV(8) again", Vcc.readmV(8));
+  report("readmV_OS(13, 4)", Vcc.readmV_OS(13, 4));
+  report("readmV_Adaptive(2, 64)", Vcc.readmV_Adaptive(2, 64));
+  // Another channel in between makes the bandgap settle again
+  analogRead(A0);
+  report("readmV(8) after analogRead", Vcc.readmV(8));
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+    report("readmV_HWOS(16, 4)", Vcc.readmV_HWOS(16, 4));
+    report("readmV_HWOS(17, 2)", Vcc.readmV_HWOS(17, 2));
+    report("readmV_HWOS(20, 1)", Vcc.readmV_HWOS(20, 1));
+    report("readmV_Zoom(4)", Vcc.readmV_Zoom(4));
+    report("readmV_Zoom(4) zoomed", Vcc.readmV_Zoom(4));
+  #elif MCUVOLTAGE_HWOS
+    report("readmV_HWOS(+3, 4)", Vcc.readmV_HWOS(MCUVOLTAGE_BIT_DEPTH + 3, 4));
+    report("readmV_HWOS(+1, 2)", Vcc.readmV_HWOS(MCUVOLTAGE_BIT_DEPTH + 1, 2));
+  #endif
+
+
+  Vcc.setNoiseReduction(true);
+  report("readmV(8) asleep", Vcc.readmV(8));
+  Vcc.setNoiseReduction(false);
+
+  Vcc.setTiming(TIMING_FAST);
+  report("readmV(8) fast", Vcc.readmV(8));
+  Vcc.setTiming(TIMING_PRECISE);
+  report("readmV(8) precise", Vcc.readmV(8));
+  Vcc.setTiming(TIMING_UNCHANGED);
+
+  // Non-blocking, the ADC interrupt does the work while time passes
+  Vcc.startReading_OS(13, 4);
+  while (!Vcc.isReady()) { delayMicroseconds(10); }
+  report("startReading_OS(13, 4)", Vcc.getmV());
+
+  // Time sliced
+  Vcc.beginOversample(14, 2);
+  while (Vcc.step(16) < 100) {}
+  report("beginOversample(14, 2)", Vcc.getmV());
+
+  // Background sampler against a falling Vcc
+  simSetVccWaveform(fallingVcc);
+  Vcc.beginSampling();
+  delay(1);
+
+  unsigned int  samples[16];
+  unsigned long mV[16];
+  byte count = Vcc.readSamples(samples, 16);
+  Vcc.stopSampling();
+  Vcc.convertSamples(samples, mV, count);
+  report("beginSampling(), last", count > 0 ? mV[count-1] : 0);
+
+  // Ripple on Vcc
+  simSetVccWaveform(NULL);
+  simSetVcc(5000);
+  simSetVccRipple(50, 1000);
+  report("readmV(64) with ripple", Vcc.readmV(64));
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Binary Stream */
+
+/*
+ * Samples a simulated Vcc with a brown-out in the middle for one second, and
+ * writes the binary frames of streamSamples() to stdout, as the example
+ * Stream_Vcc writes them to Serial. Pipe it into stream_decode for CSV:
+ *
+ *   ./host_stream | ./stream_decode > vcc.csv
+ *
+ * Like Serial at 115200 baud, stdout only takes 11520 bytes a second of
+ * simulated time, so samples are dropped if the stream cannot keep up.
+ */
+
+
+#include <MCUVoltage.h>
+#include <stdio.h>
+
+
+MCUVoltage Vcc;
+
+
+// Bytes a second Serial can send at 115200 baud, 10 bits a byte
+#define BYTES_PER_SECOND 11520
+
+
+// Writes to stdout, waiting in simulated time as long as the bytes take to send
+class StdoutPrint : public Print
+{
+  public:
+
+    size_t write(uint8_t value)
+    {
+      return write(&value, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+      delayMicroseconds(size * 1000000UL / BYTES_PER_SECOND);
+      return fwrite(buffer, 1, size, stdout);
+    }
+};
+
+
+// 3.3V, dipping to 2.7V for 20ms half a second in
+static double brownOut(double seconds)
+{
+  return (seconds > 0.5 && seconds < 0.52) ? 2700 : 3300;
+}
+
+
+int main()
+{
+  StdoutPrint output;
+
+  simSetVccWaveform(brownOut);
+  simSetNoise(0.7);
+
+  // Evenly spaced where there is a timer, free running otherwise
+  Vcc.setSamplingRate(5000);
+  Vcc.beginSampling();
+
+  while (millis() < 1000)
+  {
+    // Waits while the frame is sent, the ADC interrupt fills the buffer meanwhile
+    if (Vcc.streamSamples(output) == 0) { delayMicroseconds(100); }
+  }
+
+  Vcc.stopSampling();
+
+  fprintf(stderr, "%u samples dropped\n", Vcc.getDroppedSamples());
+
+  return 0;
+}
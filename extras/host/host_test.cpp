@@ -0,0 +1,715 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host Simulation: Checks */
+
+/*
+ * Runs the library against the simulated ADC and checks the results, for
+ * behaviour that is easy to get wrong in the registers and that the readings
+ * of host_demo would not show, and checks the integer math against the exact
+ * results worked out here. Prints every failed check and returns 1 if there
+ * was any, so it can be run for every device in a script.
+ *
+ * unsigned long is 64 bits on a 64 bit PC but 32 bits on the AVR, and int is
+ * 32 bits on the PC but 16 on the AVR, so a product that overflows on the
+ * board can come out right here. Build with -m32 where the 32 bit libraries
+ * are installed, so long is 32 bits as on the board. Either way the expected
+ * values are worked out in uint64_t, results are compared as uint32_t, and
+ * the checks of the math also check that the largest product the library
+ * forms fits in the 32 or 16 bits it has on the board.
+ */
+
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/eeprom.h>
+
+// The stream check looks at the samples waiting in the buffer of the background sampler
+#define private public
+#include <MCUVoltage.h>
+#undef private
+
+// The decoder of the frames, without its main()
+#define STREAM_DECODE_NO_MAIN
+#include "stream_decode.cpp"
+
+
+MCUVoltage Vcc;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { if (!(condition)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+// Same as CHECK, but leaves the loop it is in on the first failure, so it is reported once
+#define CHECK_LOOP(condition) \
+  if (!(condition)) { CHECK(condition); break; }
+
+// True if value fits in an unsigned long or unsigned int of the AVR
+#define FITS_32(value) ((uint64_t)(value) <= 0xFFFFFFFFULL)
+#define FITS_16(value) ((uint64_t)(value) <= 0xFFFFULL)
+
+
+// Random numbers from 0 to range - 1, the same every run
+static uint32_t randomState = 1;
+
+static uint32_t nextRandom(uint32_t range)
+{
+  randomState = randomState * 1103515245UL + 12345UL;
+  return (randomState >> 8) % range;
+}
+
+
+/*================================================================================*/
+
+
+// Vcc in millivolts from a reading, exact, bandgapQ3 has 3 fraction bits like the calibration
+static uint64_t exactVcc(uint64_t bandgapQ3, byte readingBitDepth, uint64_t reading)
+{
+  return (bandgapQ3 << (readingBitDepth - 3)) / reading;
+}
+
+
+// Reading of readingBitDepth bits that gives mV, rounded
+static uint64_t exactReading(uint64_t bandgapQ3, byte readingBitDepth, uint64_t mV)
+{
+  return ((bandgapQ3 << (readingBitDepth - 3)) + mV/2) / mV;
+}
+
+
+/*================================================================================*/
+
+
+static volatile unsigned long watchedmV = 0;
+
+static void onWatch(unsigned long mV)
+{
+  watchedmV = mV;
+}
+
+
+// watch() must stay quiet while Vcc is inside the window, and call back once it leaves.
+// The thresholds are in the accumulated bit depth, so the ADC has to really accumulate.
+static void checkWatch()
+{
+  simReset();
+  simSetVcc(3300);
+  simSetNoise(0.7);
+  watchedmV = 0;
+
+  CHECK(Vcc.watch(3000, 3600, onWatch));
+
+  delay(20);
+  CHECK(watchedmV == 0);
+  CHECK(Vcc.isWatching());
+
+  simSetVcc(2800);
+  delay(20);
+  CHECK(!Vcc.isWatching());
+  CHECK(watchedmV > 2700 && watchedmV < 3000);
+
+  Vcc.stopWatching();
+}
+
+
+/*================================================================================*/
+
+
+// stopSampling() must stop the ADC and throw away the conversion in progress,
+// so the next blocking reading takes only fresh conversions
+static void checkStopSampling()
+{
+  simReset();
+  simSetVcc(3300);
+  simSetNoise(0.7);
+
+  CHECK(Vcc.beginSampling());
+  delay(2);
+  Vcc.stopSampling();
+
+  // Conversions are counted as they start, one left over would make it 63
+  uint32_t conversions = simGetConversions();
+  unsigned long mV = Vcc.readmV(64);
+
+  CHECK(simGetConversions() - conversions == 64);
+  CHECK(mV > 3200 && mV < 3400);
+
+  // And the ADC stays stopped
+  conversions = simGetConversions();
+  delay(2);
+  CHECK(simGetConversions() == conversions);
+}
+
+
+/*================================================================================*/
+
+
+// The reciprocal lookup of setFastConversion(true) must stay within 1mV of the exact
+// division, for every bit depth a reading can have and Vcc from 1.8V to 5.5V
+static void checkFastConversion()
+{
+  uint64_t bandgapQ3 = (uint64_t)Vcc.getBandgap() << 3;
+
+  // Bandgap times 2^16/reading, at most 2^16
+  CHECK(FITS_32(bandgapQ3 * 65536));
+
+  for (byte bits=Vcc.getBitDepth(); bits<=20; bits++)
+  {
+    // The exact division shifts the bandgap up by the bit depth first
+    CHECK(FITS_32(bandgapQ3 << (bits - 3)));
+
+    for (uint32_t mV=1800; mV<=5500; mV+=3)
+    {
+      uint64_t reading = exactReading(bandgapQ3, bits, mV);
+
+      Vcc.setFastConversion(false);
+      uint32_t exact = Vcc.convertTomV(reading, bits);
+
+      Vcc.setFastConversion(true);
+      uint32_t fast = Vcc.convertTomV(reading, bits);
+
+      CHECK_LOOP(exact == exactVcc(bandgapQ3, bits, reading));
+      CHECK_LOOP(fast + 1 >= exact && fast <= exact + 1);
+    }
+  }
+
+  Vcc.setFastConversion(false);
+}
+
+
+/*================================================================================*/
+
+
+// formatmV() against printf, rounded half up to the decimals shown, and
+// convertToQ16() against mV*65536/1000 rounded, up to 65535.999V
+static void checkFormat()
+{
+  static const uint32_t values[] =
+  {
+    0, 1, 4, 5, 9, 49, 50, 99, 500, 949, 950, 999, 1000, 1499, 1500, 3300, 3349, 3350, 9950, 9999,
+    10000, 65535, 65536, 999999, 1000000, 65535999UL, 4294966795UL, 4294967294UL, 4294967295UL
+  };
+
+  const int count = sizeof(values) / sizeof(values[0]);
+
+  // Smallest step shown for 0 to 3 decimals
+  static const uint32_t steps[] = { 1000, 100, 10, 1 };
+
+  for (byte decimals=0; decimals<=4; decimals++)
+  {
+    byte shown = decimals > 3 ? 3 : decimals;
+
+    for (int i=0; i<count + 1000; i++)
+    {
+      uint32_t mV = i < count ? values[i] : (nextRandom(1UL << 24) << 8) | nextRandom(256);
+
+      // Rounded, unless that would go past the top
+      uint64_t rounded = mV;
+      if (rounded + steps[shown]/2 <= 0xFFFFFFFFULL) { rounded += steps[shown]/2; }
+
+      char expected[32];
+
+      if (shown == 0)
+      {
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)(rounded / 1000));
+      }
+      else
+      {
+        snprintf(expected, sizeof(expected), "%llu.%0*llu", (unsigned long long)(rounded / 1000),
+                 (int)shown, (unsigned long long)(rounded % 1000 / steps[shown]));
+      }
+
+      char buffer[MCUVOLTAGE_FORMAT_SIZE];
+      byte length = MCUVoltage::formatmV(mV, buffer, decimals);
+
+      CHECK_LOOP(strcmp(buffer, expected) == 0);
+      CHECK_LOOP(length == strlen(expected));
+    }
+  }
+
+  for (int i=0; i<count + 1000; i++)
+  {
+    uint32_t mV = i < count ? values[i] : nextRandom(65536000UL);
+    if (mV > 65535999UL) { continue; }
+
+    uint64_t expected = ((uint64_t)mV * 65536 + 500) / 1000;
+
+    CHECK_LOOP(FITS_32(expected));
+    CHECK_LOOP((uint32_t)MCUVoltage::convertToQ16(mV) == expected);
+  }
+}
+
+
+/*================================================================================*/
+
+
+// The median and trimmed mean filters against sorting the window here, for every window size
+static void checkFilters()
+{
+  static const byte filters[] = { FILTER_MEDIAN, FILTER_TRIMMED };
+  static const byte sizes[] = { 3, 5, 7 };
+
+  unsigned int top = (1U << Vcc.getBitDepth()) - 1;
+
+  for (byte f=0; f<sizeof(filters); f++)
+  {
+    for (byte s=0; s<sizeof(sizes); s++)
+    {
+      byte size = sizes[s];
+      if (size > MCUVOLTAGE_FILTER_SIZE) { continue; }
+
+      CHECK(Vcc.setFilter(filters[f], size));
+
+      unsigned int window[7];
+      byte         next = 0;
+
+      for (int i=0; i<2000; i++)
+      {
+        // Mostly near one value with ties, some spikes anywhere up to the top
+        unsigned int reading = nextRandom(10) == 0 ? 1 + nextRandom(top) : 300 + nextRandom(8);
+
+        // The first reading fills the window
+        if (i == 0) { for (byte j=0; j<size; j++) { window[j] = reading; } }
+
+        window[next] = reading;
+        next = (next + 1) % size;
+
+        unsigned int sorted[7];
+        memcpy(sorted, window, sizeof(sorted));
+
+        for (byte a=1; a<size; a++)
+        {
+          for (byte b=a; b>0 && sorted[b-1] > sorted[b]; b--)
+          {
+            unsigned int swap = sorted[b];
+            sorted[b] = sorted[b-1];
+            sorted[b-1] = swap;
+          }
+        }
+
+        unsigned int expected = sorted[size/2];
+
+        if (filters[f] == FILTER_TRIMMED)
+        {
+          uint32_t sum = 0;
+          for (byte j=1; j<size-1; j++) { sum += sorted[j]; }
+
+          // Summed in an unsigned int
+          CHECK_LOOP(FITS_16(sum + (size - 2)/2));
+
+          expected = (sum + (size - 2)/2) / (size - 2);
+        }
+
+        unsigned long mV = Vcc.filtermV(reading);
+
+        CHECK_LOOP(Vcc.getLastADCReading() == expected);
+        CHECK_LOOP(mV == Vcc.convertTomV(expected, Vcc.getBitDepth()));
+      }
+    }
+  }
+
+  CHECK(!Vcc.setFilter(FILTER_MEDIAN, 4));
+  CHECK(Vcc.setFilter(FILTER_NONE, 0));
+}
+
+
+/*================================================================================*/
+
+
+// Goes up, stays flat, up, down, and has a long segment so the 32 bit divide is used
+static const MCUVoltageBatteryPoint testCurve[] PROGMEM =
+{
+  {1800, 0}, {2100, 3}, {2500, 3}, {3000, 100}, {3200, 60}, {9000, 0}
+};
+
+
+// Percent from curve worked out here, rounded to the nearest
+static byte expectedPercent(const MCUVoltageBatteryPoint* curve, byte count, uint32_t mV)
+{
+  if (mV <= curve[0].mV) { return curve[0].percent; }
+  if (mV >= curve[count-1].mV) { return curve[count-1].percent; }
+
+  byte i = 0;
+  while (curve[i+1].mV <= mV) { i++; }
+
+  int64_t span = curve[i+1].mV - curve[i].mV;
+  int64_t change = (int64_t)curve[i+1].percent - curve[i].percent;
+  int64_t offset = mV - curve[i].mV;
+
+  // Half rounds away from the first point
+  int64_t step = ((change < 0 ? -change : change) * offset + span/2) / span;
+
+  return change < 0 ? curve[i].percent - step : curve[i].percent + step;
+}
+
+
+// convertToPercent() on every millivolt of a curve, and on the points of the built in ones
+static void checkBattery()
+{
+  MCUVoltage battery;
+
+  CHECK(battery.convertToPercent(3700) == 0);
+  CHECK(!battery.setBattery(testCurve, 1));
+  CHECK(!battery.setBattery(0));
+  CHECK(!battery.setBattery(BATTERY_COIN + 1));
+
+  CHECK(battery.setBattery(testCurve, sizeof(testCurve)/sizeof(testCurve[0])));
+
+  for (uint32_t mV=0; mV<=10000; mV++)
+  {
+    CHECK_LOOP(battery.convertToPercent(mV) == expectedPercent(testCurve, sizeof(testCurve)/sizeof(testCurve[0]), mV));
+  }
+
+  CHECK(battery.convertToPercent(0xFFFFFFFFUL) == 0);
+
+  // A few points of each built in curve, and halfway between two
+  CHECK(battery.setBattery(BATTERY_LIION));
+  CHECK(battery.convertToPercent(2900) == 0);
+  CHECK(battery.convertToPercent(3820) == 45);
+  CHECK(battery.convertToPercent(3830) == 48);
+  CHECK(battery.convertToPercent(4200) == 100);
+
+  CHECK(battery.setBattery(BATTERY_ALKALINE_2));
+  CHECK(battery.convertToPercent(2650) == 55);
+
+  CHECK(battery.setBattery(BATTERY_NIMH_3));
+  CHECK(battery.convertToPercent(4050) == 95);
+
+  CHECK(battery.setBattery(BATTERY_COIN));
+  CHECK(battery.convertToPercent(2100) == 3);
+}
+
+
+/*================================================================================*/
+
+
+// n/d rounded to the nearest, half away from 0, as the library does
+static int64_t divideRounded(int64_t n, int64_t d)
+{
+  return n >= 0 ? (n + d/2) / d : -((-n + d/2) / d);
+}
+
+
+// Every reading from 1.8V to 5.5V must convert with bandgapQ3 and offset
+static bool convertsWith(uint64_t bandgapQ3, int64_t offset)
+{
+  byte bits = Vcc.getBitDepth();
+
+  for (uint32_t mV=1800; mV<=5500; mV+=50)
+  {
+    uint64_t reading = exactReading((uint64_t)Vcc.getBandgap() << 3, bits, mV);
+    int64_t  expected = exactVcc(bandgapQ3, bits, reading) + offset;
+
+    if (Vcc.convertTomV(reading, bits) != (uint32_t)(expected > 0 ? expected : 0)) { return false; }
+  }
+
+  return true;
+}
+
+
+// The one and two point fits against the math here, and the CRC of the saved calibration
+static void checkCalibration()
+{
+  simEraseEEPROM();
+  Vcc.clearCalibration();
+
+  byte     bits = Vcc.getBitDepth();
+  uint64_t bandgapQ3 = (uint64_t)Vcc.getBandgap() << 3;
+
+  CHECK(!Vcc.isCalibrated());
+  CHECK(convertsWith(bandgapQ3, 0));
+
+  // One point, a gain only
+  uint64_t reading = exactReading(bandgapQ3, bits, 3300);
+  uint32_t measured = Vcc.convertTomV(reading, bits);
+
+  CHECK(!Vcc.calibrate(0, 3300));
+  CHECK(!Vcc.calibrate(measured, 40000));
+  CHECK(!Vcc.isCalibrated());
+
+  CHECK(Vcc.calibrate(measured, 3250));
+  CHECK(Vcc.isCalibrated());
+  CHECK(Vcc.getOffset_Calibration() == 0);
+
+  // The largest product is bandgap times the largest mV taken, 32767
+  CHECK(FITS_32(0xFFFF * 32767ULL));
+
+  uint64_t gainQ3 = (bandgapQ3 * 3250 + measured/2) / measured;
+  CHECK(convertsWith(gainQ3, 0));
+  CHECK(Vcc.convertTomV(reading, bits) + 1 >= 3250 && Vcc.convertTomV(reading, bits) <= 3250 + 1);
+
+  // Two points, a gain and an offset, starting over
+  Vcc.clearCalibration();
+
+  uint64_t reading1 = exactReading(bandgapQ3, bits, 3000);
+  uint64_t reading2 = exactReading(bandgapQ3, bits, 4500);
+  int64_t  measured1 = Vcc.convertTomV(reading1, bits);
+  int64_t  measured2 = Vcc.convertTomV(reading2, bits);
+  int64_t  actual1 = measured1 - 25;
+  int64_t  actual2 = measured2 + 40;
+
+  CHECK(!Vcc.calibrate(measured1, actual1, measured1, actual2));
+  CHECK(!Vcc.calibrate(measured1, actual2, measured2, actual1));
+  CHECK(!Vcc.isCalibrated());
+
+  CHECK(Vcc.calibrate(measured1, actual1, measured2, actual2));
+
+  int64_t num = actual2 - actual1;
+  int64_t den = measured2 - measured1;
+  uint64_t fitQ3 = (bandgapQ3 * num + den/2) / den;
+  int64_t  fitOffset = divideRounded(-measured1 * num, den) + actual1;
+
+  CHECK(FITS_32(bandgapQ3 * num));
+  CHECK(Vcc.getOffset_Calibration() == fitOffset);
+  CHECK(convertsWith(fitQ3, fitOffset));
+  CHECK(llabs((int64_t)Vcc.convertTomV(reading1, bits) - actual1) <= 1);
+  CHECK(llabs((int64_t)Vcc.convertTomV(reading2, bits) - actual2) <= 1);
+
+  // Saved and loaded back
+  Vcc.saveCalibration();
+  Vcc.clearCalibration();
+  CHECK(convertsWith(bandgapQ3, 0));
+
+  CHECK(Vcc.loadCalibration());
+  CHECK(Vcc.isCalibrated());
+  CHECK(convertsWith(fitQ3, fitOffset));
+
+  // Any byte changed fails the version or the CRC, and nothing changes
+  byte record[MCUVOLTAGE_CALIBRATION_SIZE];
+  eeprom_read_block(record, (const void*)MCUVOLTAGE_CALIBRATION_ADDRESS, MCUVOLTAGE_CALIBRATION_SIZE);
+
+  for (byte i=0; i<MCUVOLTAGE_CALIBRATION_SIZE; i++)
+  {
+    byte changed[MCUVOLTAGE_CALIBRATION_SIZE];
+    memcpy(changed, record, sizeof(changed));
+    changed[i] ^= 0b00010000;
+
+    eeprom_update_block(changed, (void*)MCUVOLTAGE_CALIBRATION_ADDRESS, MCUVOLTAGE_CALIBRATION_SIZE);
+    Vcc.clearCalibration();
+
+    CHECK_LOOP(!Vcc.loadCalibration());
+    CHECK_LOOP(!Vcc.isCalibrated());
+    CHECK_LOOP(convertsWith(bandgapQ3, 0));
+  }
+
+  // Erased
+  simEraseEEPROM();
+  CHECK(!Vcc.loadCalibration());
+
+  Vcc.clearCalibration();
+}
+
+
+/*================================================================================*/
+
+
+// Keeps every byte written, for the decoder
+class MemoryPrint : public Print
+{
+  public:
+
+    uint8_t data[65536];
+    size_t  length = 0;
+
+    size_t write(uint8_t value)
+    {
+      return write(&value, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+      if (length + size > sizeof(data)) { return 0; }
+
+      memcpy(data + length, buffer, size);
+      length += size;
+
+      return size;
+    }
+};
+
+
+// Jumps between 2V, 3.3V and 4.8V every millisecond, so the deltas go both ways and take more than a byte
+static double steps(double seconds)
+{
+  static const double levels[] = { 3300, 2000, 4800 };
+  return levels[(unsigned long)(seconds * 1000) % 3];
+}
+
+
+// Frames of streamSamples() through decodeStream() of stream_decode.cpp must give back every
+// sample with its index counting the dropped ones, and the same mV as convertTomV(), across
+// the sequence wrapping and the header sent again
+static void checkStream()
+{
+  static MemoryPrint   output;
+  static unsigned int  raws[8192];
+  static unsigned long indices[8192];
+
+  simReset();
+  simSetVccWaveform(steps);
+  simSetNoise(0.7);
+
+  MCUVoltage::setSamplingRate(0);
+  CHECK(Vcc.beginSampling());
+
+  unsigned int  frames = 0;
+  unsigned int  samples = 0;
+  unsigned long index = 0;
+  unsigned int  droppedBefore = 0;
+
+  while (frames < 300)
+  {
+    // What streamSamples() takes. It reads the buffer before it touches a register, and
+    // interrupts only come in on a register, so nothing is added meanwhile.
+    byte waiting = Vcc.available();
+    byte taken = waiting < MCUVOLTAGE_STREAM_FRAME_SIZE ? waiting : MCUVOLTAGE_STREAM_FRAME_SIZE;
+
+    for (byte i=0; i<taken; i++)
+    {
+      raws[samples + i] = MCUVoltage::sampleBuffer[(MCUVoltage::sampleTail + i) & (MCUVOLTAGE_BUFFER_SIZE - 1)];
+    }
+
+    byte count = Vcc.streamSamples(output);
+    CHECK_LOOP(count == taken);
+
+    if (count == 0)
+    {
+      delayMicroseconds(50);
+      continue;
+    }
+
+    // The dropped samples the frame tells of
+    index += (unsigned int)(MCUVoltage::dropped_Stream - droppedBefore);
+    droppedBefore = MCUVoltage::dropped_Stream;
+
+    for (byte i=0; i<count; i++) { indices[samples++] = index++; }
+
+    frames++;
+
+    // Now and then too long for the buffer, so samples are dropped
+    if (frames % 40 == 0) { delay(10); }
+  }
+
+  Vcc.stopSampling();
+  simSetVccWaveform(NULL);
+
+  CHECK(droppedBefore > 0);
+
+  FILE* input = tmpfile();
+  csv = tmpfile();
+  report = tmpfile();
+
+  CHECK(input != NULL && csv != NULL && report != NULL);
+  if (input == NULL || csv == NULL || report == NULL) { return; }
+
+  fwrite(output.data, 1, output.length, input);
+  rewind(input);
+
+  decodeStream(input);
+  rewind(csv);
+
+  CHECK(lostFrames == 0 && badFrames == 0);
+
+  unsigned long long sample;
+  double             seconds;
+  unsigned long      raw, mV;
+  unsigned int       decoded = 0;
+
+  while (fscanf(csv, "%llu,%lf,%lu,%lu\n", &sample, &seconds, &raw, &mV) == 4)
+  {
+    CHECK_LOOP(decoded < samples);
+    CHECK_LOOP(sample == indices[decoded]);
+    CHECK_LOOP(raw == raws[decoded]);
+    CHECK_LOOP(mV == Vcc.convertTomV(raw, Vcc.getBitDepth()));
+
+    decoded++;
+  }
+
+  CHECK(decoded == samples);
+
+  fclose(input);
+  fclose(csv);
+  fclose(report);
+}
+
+
+/*================================================================================*/
+
+
+#if MCUVOLTAGE_HWOS
+
+// Every hardware oversampled bit depth must take 4 times the samples for each bit, past 17 bits
+// on the ATtiny3224/3226/3227 by adding up bursts of 1024, and give twice the reading of one bit less
+static void checkHWOS()
+{
+  simReset();
+  simSetVcc(3300);
+  simSetNoise(0.7);
+
+  byte     native = Vcc.getBitDepth();
+  uint64_t previous = 0;
+
+  // Out of range goes to the default
+  Vcc.ADCSetup_HWOS(MCUVoltage::maxBD_HWOS + 1);
+  CHECK(Vcc.getBitDepth_HWOS() == MCUVoltage::defaultBD_HWOS);
+
+  for (byte bits=MCUVoltage::minBD_HWOS; bits<=MCUVoltage::maxBD_HWOS; bits++)
+  {
+    uint64_t samples = 1ULL << ((bits - native) * 2);
+
+    // Every sample added up, before it is shifted down to the bit depth
+    CHECK_LOOP(FITS_32(samples << native));
+
+    // Once to set up and settle
+    Vcc.readmV_HWOS(bits, 1);
+
+    uint32_t before = simGetConversions();
+    unsigned long mV = Vcc.readmV_HWOS(bits, 1);
+
+    CHECK_LOOP(simGetConversions() - before == samples);
+    CHECK_LOOP(Vcc.getBitDepth_HWOS() == bits);
+
+    // Noise of 0.7 steps averages down as fast as the steps get smaller
+    uint64_t reading = Vcc.getLastADCReading();
+
+    CHECK_LOOP(previous == 0 || (reading + 6 >= previous * 2 && reading <= previous * 2 + 6));
+    CHECK_LOOP(mV == Vcc.convertTomV(reading, bits));
+    CHECK_LOOP(mV > 3250 && mV < 3350);
+
+    previous = reading;
+  }
+}
+
+#endif
+
+
+/*================================================================================*/
+
+
+int main()
+{
+  checkWatch();
+  checkStopSampling();
+  checkFastConversion();
+  checkFormat();
+  checkFilters();
+  checkBattery();
+  checkCalibration();
+  checkStream();
+
+  #if MCUVOLTAGE_HWOS
+    checkHWOS();
+  #endif
+
+  printf("%s\n", failures == 0 ? "all passed" : "failed");
+
+  return failures == 0 ? 0 : 1;
+}
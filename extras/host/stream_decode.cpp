@@ -0,0 +1,302 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Host: Binary Stream Decoder */
+
+/*
+ * Reads the binary frames of streamSamples() from a file or stdin, such as a
+ * serial port, and prints one CSV line for every sample:
+ *
+ *   sample,seconds,raw,mV
+ *
+ * sample counts from 0 since beginSampling(), including the samples dropped on
+ * the board, so seconds stays right across them. mV is worked out the same way
+ * as convertToVcc() on the board, from the last header frame. Samples before
+ * the first header are skipped. Bad frames are skipped up to the next 0xA5, and
+ * lost frames are reported on stderr. Does not need the library:
+ *
+ *   g++ -O2 -o stream_decode extras/host/stream_decode.cpp
+ *   ./stream_decode vcc.bin > vcc.csv
+ *
+ * See streamSamples() in src/MCUVoltage_Stream.cpp for the frames. host_test
+ * includes this file with STREAM_DECODE_NO_MAIN to check the frames round trip.
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define SYNC_STREAM    0xA5
+#define HEADER_STREAM  'H'
+#define DATA_STREAM    'D'
+#define VERSION_STREAM 1
+
+// Header frames are always this long
+#define HEADER_BYTES 16
+
+// Longest data frame, 255 samples of 3 bytes
+#define MAX_FRAME_BYTES (4 + 3 + 3 * 255 + 1)
+
+
+// From the last header frame
+static bool     haveHeader = false;
+static uint8_t  bitDepth = 10;
+static uint16_t bandgapQ3 = 1100 << 3;
+static int16_t  offset = 0;
+static uint32_t rate = 0;
+
+// Where the stream is up to
+static bool     haveSequence = false;
+static uint8_t  nextSequence = 0;
+static uint64_t sampleIndex = 0;
+static uint32_t lostFrames = 0;
+static uint32_t badFrames = 0;
+
+// Where the CSV lines go, and the header, drops and lost frames are reported
+static FILE*    csv = stdout;
+static FILE*    report = stderr;
+
+
+/*================================================================================*/
+
+
+// Same CRC-8 as the board, polynomial 0x07
+static uint8_t crc8(const uint8_t* data, size_t length)
+{
+  uint8_t crc = 0;
+
+  for (size_t i=0; i<length; i++)
+  {
+    crc ^= data[i];
+
+    for (int b=0; b<8; b++)
+    {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+
+/*================================================================================*/
+
+
+// Read a varint at *position, at most 3 bytes. Returns false if it runs past length.
+static bool getVarint(const uint8_t* frame, size_t length, size_t* position, uint32_t* value)
+{
+  *value = 0;
+
+  for (int shift=0; shift<21; shift+=7)
+  {
+    if (*position >= length) { return false; }
+
+    uint8_t next = frame[(*position)++];
+    *value |= (uint32_t)(next & 0x7F) << shift;
+
+    if ((next & 0x80) == 0) { return true; }
+  }
+
+  return false;
+}
+
+
+/*================================================================================*/
+
+
+// Vcc in millivolts, as convertToVcc() on the board
+static unsigned long convertToVcc(uint32_t raw)
+{
+  if (raw == 0) { return 0; }
+
+  long mV = ((unsigned long)bandgapQ3 << (bitDepth - 3)) / raw;
+
+  if (offset != 0) { mV += offset; }
+
+  return mV > 0 ? mV : 0;
+}
+
+
+/*================================================================================*/
+
+
+// Try to take one frame from the start of buffer, which starts with the sync byte.
+// Returns the length of the frame, 0 if more bytes are needed, -1 if it is not a frame.
+static int decodeFrame(const uint8_t* buffer, size_t length)
+{
+  if (length < 2) { return 0; }
+
+  if (buffer[1] == HEADER_STREAM)
+  {
+    if (length < HEADER_BYTES) { return 0; }
+    if (crc8(buffer + 1, HEADER_BYTES - 2) != buffer[HEADER_BYTES - 1]) { return -1; }
+    if (buffer[2] != VERSION_STREAM) { return -1; }
+
+    bitDepth  = buffer[4];
+    bandgapQ3 = buffer[7] | (buffer[8] << 8);
+    offset    = (int16_t)(buffer[9] | (buffer[10] << 8));
+    rate      = buffer[11] | (buffer[12] << 8) | (buffer[13] << 16) | ((uint32_t)buffer[14] << 24);
+
+    if (!haveHeader)
+    {
+      fprintf(report, "device %u, %u bits, bandgap %umV, %lu samples per second\n",
+              buffer[3], bitDepth, buffer[5] | (buffer[6] << 8), (unsigned long)rate);
+    }
+
+    haveHeader = true;
+
+    return HEADER_BYTES;
+  }
+
+  if (buffer[1] != DATA_STREAM) { return -1; }
+  if (length < 4) { return 0; }
+
+  uint8_t sequence = buffer[2];
+  uint8_t count = buffer[3];
+
+  if (count == 0) { return -1; }
+
+  // Find the end of the frame before using any of it
+  size_t   position = 4;
+  uint32_t dropped = 0;
+  uint32_t raw[256];
+
+  for (int i=-1; i<count; i++)
+  {
+    uint32_t value;
+
+    if (!getVarint(buffer, length, &position, &value))
+    {
+      return length < MAX_FRAME_BYTES ? 0 : -1;
+    }
+
+    if (i < 0)       { dropped = value; }
+    else if (i == 0) { raw[0] = value; }
+
+    // Undo the zig-zag, then add the delta to the sample before
+    else { raw[i] = raw[i-1] + ((value & 1) ? -(int32_t)((value + 1) >> 1) : (int32_t)(value >> 1)); }
+  }
+
+  if (position >= length) { return 0; }
+  if (crc8(buffer + 1, position - 1) != buffer[position]) { return -1; }
+
+  if (haveSequence && sequence != nextSequence)
+  {
+    lostFrames += (uint8_t)(sequence - nextSequence);
+    fprintf(report, "%u frames lost before sample %llu\n",
+            (uint8_t)(sequence - nextSequence), (unsigned long long)sampleIndex);
+  }
+
+  haveSequence = true;
+  nextSequence = sequence + 1;
+  sampleIndex += dropped;
+
+  if (dropped > 0)
+  {
+    fprintf(report, "%lu samples dropped before sample %llu\n",
+            (unsigned long)dropped, (unsigned long long)sampleIndex);
+  }
+
+  for (int i=0; i<count; i++)
+  {
+    if (haveHeader)
+    {
+      fprintf(csv, "%llu,%.6f,%lu,%lu\n", (unsigned long long)sampleIndex,
+              rate > 0 ? (double)sampleIndex / rate : 0.0,
+              (unsigned long)raw[i], convertToVcc(raw[i]));
+    }
+
+    sampleIndex++;
+  }
+
+  return position + 1;
+}
+
+
+/*================================================================================*/
+
+
+// Decode every frame in input, to the end
+static void decodeStream(FILE* input)
+{
+  static uint8_t buffer[4 * MAX_FRAME_BYTES];
+  size_t length = 0;
+  bool   done = false;
+
+  while (!done || length > 0)
+  {
+    // Keep the buffer topped up
+    if (!done && length < sizeof(buffer))
+    {
+      size_t got = fread(buffer + length, 1, sizeof(buffer) - length, input);
+      if (got == 0) { done = true; }
+      length += got;
+    }
+
+    // Look for the next frame
+    size_t start = 0;
+    while (start < length && buffer[start] != SYNC_STREAM) { start++; }
+
+    memmove(buffer, buffer + start, length - start);
+    length -= start;
+
+    if (length == 0) { continue; }
+
+    int used = decodeFrame(buffer, length);
+
+    // Wait for more, unless there is no more to come
+    if (used == 0 && !done) { continue; }
+
+    // Not a frame, or cut off at the end, skip the sync byte and look again
+    if (used <= 0)
+    {
+      badFrames++;
+      used = 1;
+    }
+
+    memmove(buffer, buffer + used, length - used);
+    length -= used;
+  }
+}
+
+
+/*================================================================================*/
+
+
+#ifndef STREAM_DECODE_NO_MAIN
+
+int main(int argc, char** argv)
+{
+  FILE* input = stdin;
+
+  if (argc > 1 && (input = fopen(argv[1], "rb")) == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  fprintf(csv, "sample,seconds,raw,mV\n");
+
+  decodeStream(input);
+
+  fflush(csv);
+
+  if (lostFrames > 0 || badFrames > 0)
+  {
+    fprintf(report, "%lu frames lost, %lu bad frames skipped\n", (unsigned long)lostFrames, (unsigned long)badFrames);
+  }
+
+  if (input != stdin) { fclose(input); }
+
+  return 0;
+}
+
+#endif
@@ -13,6 +13,13 @@
 #include "MCUVoltage.h"
 
 
+// No reading in progress
+MCUVoltage* volatile MCUVoltage::activeInstance = NULL;
+
+// Only set when setNoiseReduction() is used
+unsigned long (*MCUVoltage::sleepConversion)() = NULL;
+
+
 /*================================================================================*/
 
 
@@ -30,14 +37,31 @@ MCUVoltage::MCUVoltage() : MCUVoltage(0)
 // Constructor with user input bandgap voltage
 MCUVoltage::MCUVoltage(unsigned int myBandgap)
 {
-  setBandgap(myBandgap);
-  
-  // MUST cast to unsigned long.
-  precompValue = (unsigned long)bandgap*(unsigned long)resolution;
+  // This also precomputes the values that depend on the bandgap
+  if (!setBandgap(myBandgap)) { setBandgap(MCUVOLTAGE_BANDGAP); }
+
+  // Boot straight into the calibration saved by saveCalibration(), unless a bandgap was passed
+  #if MCUVOLTAGE_LOAD_CALIBRATION
+    if (myBandgap == 0) { loadCalibration(); }
+  #endif
 
   #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
   
     device = ATTINY322X;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC && defined(VREF_ADC0REF)
+
+    // Only the AVR Dx has a separate reference for the ADC
+    device = AVR_DX;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC && defined(AC0_DACREF)
+
+    // The megaAVR 0-series has DACREF, the tinyAVR 0/1-series does not
+    device = MEGAAVR_0;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    device = TINYAVR_01;
     
   #elif defined(__AVR_ATmega328__) || defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328PB__)
 
@@ -68,8 +92,36 @@ MCUVoltage::MCUVoltage(unsigned int myBandgap)
 #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
 
   // Setup to read a single conversion in 12 bits
-  void MCUVoltage::ADCSetup()
+  bool MCUVoltage::setupRegisters()
   {
+    // Freerun and left adj disabled, single sample
+    // Single ended 12 bit mode
+    return setupRegisters(0b00000000, 0b00010000);
+  }
+
+  // Setup to read the bandgap against Vcc, with the given sample accumulation and mode.
+  // Returns false without touching the ADC if it is already set up this way.
+  bool MCUVoltage::setupRegisters(byte myCTRLF, byte myCOMMAND)
+  {
+    // Prescaler and sample duration, does not need a reading thrown away
+    setupTiming();
+
+    // Check what is in the registers rather than what we last wrote,
+    // so changes made by analogRead() or other code are caught too.
+    // The bandgap only has to settle again if the reference or mux changed.
+    bool switched = !( VREF.CTRLA == 0b00000000 &&
+                       AC0.DACREF == 0b11111111 &&
+                       (ADC0.CTRLA & 0b00000001) &&
+                       ADC0.MUXPOS == 0b00110011 &&
+                       (ADC0.CTRLC & 0b00000111) == 0b00000000 );
+
+    if ( !switched &&
+         ADC0.CTRLF == myCTRLF &&
+         (ADC0.COMMAND & 0b11110000) == myCOMMAND )
+    {
+      return false;
+    }
+
     // Set reference voltage to 1.024V
     VREF.CTRLA = 0b00000000; 
     
@@ -82,28 +134,170 @@ MCUVoltage::MCUVoltage(unsigned int myBandgap)
     // Set refence voltage as incoming voltage, disable PGA
     ADC0.MUXPOS = 0b00110011; 
     
-    // Freerun and left adj disabled, single sample
-    ADC0.CTRLF = 0b00000000; 
+    // Freerun, left adj and sample accumulation
+    ADC0.CTRLF = myCTRLF; 
 
     // Compare against Vcc, clear last three bits, ignore TIMEBASE
     ADC0.CTRLC &= ~(0b00000111); 
 
-    // Set 12 bit mode
-    ADC0.COMMAND |= 0b00010000; 
+    // Set the mode, overwrite rather than OR so a previous mode does not linger
+    ADC0.COMMAND = myCOMMAND; 
+
+    // The bandgap needs time to settle from now
+    if (switched) { startSettling(); }
+
+    #if MCUVOLTAGE_STATS
+      stats.setups++;
+    #endif
+
+    return true;
   }
   
   // Read the ADC value of bandgap against VCC
-  unsigned int MCUVoltage::readADC()
+  unsigned long MCUVoltage::convertOnce()
   {
     ADC0.COMMAND |= 0b00000001; // Start conversion
 
     // When Bit 0 of STATUS is 1, ADC is converting, wait. Conversion done when it is 0.
     while ( ADC0.STATUS > 0 ){}
 
-    // lastADCReading enough to hold all of RESULT
-    lastADCReading = ADC0.RESULT;
-  
-    return lastADCReading;
+    // Read the whole 32 bits, accumulated results can be more than 16 bits
+    return ADC0.RESULT;
+  }
+
+  void MCUVoltage::disableADCInterrupt()
+  {
+    // Disable RESRDY interrupt
+    ADC0.INTCTRL &= ~(0b00000001);
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // Setup to read a single conversion in 10 bits, 12 bits for AVR Dx
+  bool MCUVoltage::setupRegisters()
+  {
+    // Single sample
+    return setupRegisters(0b00000000);
+  }
+
+  // Setup to read the bandgap against Vcc, accumulating 2^mySAMPNUM samples.
+  // Returns false without touching the ADC if it is already set up this way.
+  bool MCUVoltage::setupRegisters(byte mySAMPNUM)
+  {
+    // Prescaler and sample length, does not need a reading thrown away
+    setupTiming();
+
+    // Check what is in the registers rather than what we last wrote,
+    // so changes made by analogRead() or other code are caught too.
+    // The bandgap only has to settle again if the reference or mux changed.
+    #if defined(VREF_ADC0REF)
+
+      // AVR Dx: DACREF0 from the 1.024V reference against VDD
+      bool switched = !( VREF.ACREF == 0b00000000 &&
+                         AC0.DACREF == 0b11111111 &&
+                         (VREF.ADC0REF & 0b00000111) == 0b00000101 &&
+                         ADC0.MUXPOS == 0b01001001 &&
+                         (ADC0.CTRLA & 0b00000001) );
+
+    #elif defined(AC0_DACREF)
+
+      // megaAVR 0-series: DACREF from the 1.1V AC0 reference against VDD
+      bool switched = !( (VREF.CTRLA & 0b00000111) == 0b00000001 &&
+                         AC0.DACREF == 0b11111111 &&
+                         (ADC0.CTRLC & 0b01110000) == 0b01010000 &&
+                         ADC0.MUXPOS == 0b00011100 &&
+                         (ADC0.CTRLA & 0b00000001) );
+
+    #else
+
+      // tinyAVR 0/1-series: the 1.1V ADC0 reference (INTREF) against VDD
+      bool switched = !( (VREF.CTRLA & 0b01110000) == 0b00010000 &&
+                         (ADC0.CTRLC & 0b01110000) == 0b01010000 &&
+                         ADC0.MUXPOS == 0b00011101 &&
+                         (ADC0.CTRLA & 0b00000001) );
+
+    #endif
+
+    // Enabled with nothing else in CTRLA, so no freerun, full resolution and right adjusted
+    if ( !switched &&
+         ADC0.CTRLA == 0b00000001 &&
+         ADC0.CTRLB == mySAMPNUM )
+    {
+      return false;
+    }
+
+    #if defined(VREF_ADC0REF)
+
+      // Set the AC reference to 1.024V, DACREF0 will be 255/256*1.024V
+      VREF.ACREF = 0b00000000;
+      AC0.DACREF = 0b11111111;
+
+      // Compare against VDD, ignore ALWAYSON
+      VREF.ADC0REF = (VREF.ADC0REF & 0b11111000) | 0b00000101;
+
+      // DACREF0 as incoming voltage
+      ADC0.MUXPOS = 0b01001001;
+
+    #elif defined(AC0_DACREF)
+
+      // Set the AC0 reference (Bit 2:0) to 1.1V, DACREF will be 255/256*1.1V
+      VREF.CTRLA = (VREF.CTRLA & 0b11111000) | 0b00000001;
+      AC0.DACREF = 0b11111111;
+
+      // Compare against VDD (Bit 5:4) with the smaller sample capacitor (Bit 6), keep the prescaler
+      ADC0.CTRLC = (ADC0.CTRLC & 0b00000111) | 0b01010000;
+
+      // DACREF as incoming voltage
+      ADC0.MUXPOS = 0b00011100;
+
+    #else
+
+      // Set the ADC0 reference (Bit 6:4) to 1.1V
+      VREF.CTRLA = (VREF.CTRLA & 0b10001111) | 0b00010000;
+
+      // Compare against VDD (Bit 5:4) with the smaller sample capacitor (Bit 6), keep the prescaler
+      ADC0.CTRLC = (ADC0.CTRLC & 0b00000111) | 0b01010000;
+
+      // ADC0 reference (INTREF) as incoming voltage
+      ADC0.MUXPOS = 0b00011101;
+
+    #endif
+
+    // Sample accumulation
+    ADC0.CTRLB = mySAMPNUM;
+
+    // Enable ADC, overwrite to clear freerun, resolution, left adj and RUNSTBY
+    ADC0.CTRLA = 0b00000001;
+
+    // The bandgap needs time to settle from now
+    if (switched) { startSettling(); }
+
+    #if MCUVOLTAGE_STATS
+      stats.setups++;
+    #endif
+
+    return true;
+  }
+
+  // Read the ADC value of bandgap against VCC
+  unsigned long MCUVoltage::convertOnce()
+  {
+    ADC0.COMMAND = 0b00000001; // Start conversion
+
+    // Bit 0 (STCONV) reads 1 while converting, conversion done when it is 0
+    while ( ADC0.COMMAND & 0b00000001 ){}
+
+    // 16 bits, accumulated results included
+    return ADC0.RES;
+  }
+
+  void MCUVoltage::disableADCInterrupt()
+  {
+    // Disable RESRDY interrupt
+    ADC0.INTCTRL &= ~(0b00000001);
   }
 
 
@@ -112,44 +306,75 @@ MCUVoltage::MCUVoltage(unsigned int myBandgap)
 // 328/328P, 48/48P, 88/88P, 168/168P
 #else
 
-  // Setup to read a single conversion in 12 bits
-  void MCUVoltage::ADCSetup()
+  // Setup to read a single conversion in 10 bits.
+  // Returns false without touching the ADC if it is already set up.
+  bool MCUVoltage::setupRegisters()
   {
      // For Leonardo, Micro, Pro Micro
     #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
-    
+
       // Set bandgap to measure against VCC, disable left adj
-      ADMUX = 0b01011110;
-      // turn off MUX5 from ADCSRB ~00100000=11011111
-      ADCSRB &= 0b11011111; 
+      const byte myADMUX = 0b01011110;
+      // MUX5 in ADCSRB
+      const byte MUX5 = 0b00100000;
 
     #elif defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) || \
           defined(__AVR_ATmega1281__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
 
       // Set bandgap to measure against VCC, disable left adj
-      ADMUX = 0b01011110;
-      // turn off MUX5 from ADCSRB ~00001000=11110111
-      ADCSRB &= 0b11110111; 
-      
-    
+      const byte myADMUX = 0b01011110;
+      // MUX5 in ADCSRB
+      const byte MUX5 = 0b00001000;
+
     #else // Else assume to be ATmega48/88/168/328 and their 'P' versions
-    
+
       // Set bandgap to measure against VCC, disable left adj
-      ADMUX = 0b01001110; 
-      
+      const byte myADMUX = 0b01001110;
+      // No MUX5
+      const byte MUX5 = 0b00000000;
+
     #endif
 
+    // Prescaler, does not need a reading thrown away
+    setupTiming();
+
+    // Check what is in the registers rather than what we last wrote,
+    // so changes made by analogRead() or other code are caught too.
+    // The bandgap only has to settle again if the reference or mux changed, or the ADC was off
+    bool switched = !( ADMUX == myADMUX &&
+                       (ADCSRB & MUX5) == 0 &&
+                       (ADCSRA & 0b10000000) );
+
+    // ADC enabled (Bit 7) and auto trigger (Bit 5) disabled
+    if ( !switched && (ADCSRA & 0b00100000) == 0 )
+    {
+      return false;
+    }
+
+    ADMUX = myADMUX;
+
+    // Turn off MUX5, if any
+    ADCSRB &= ~MUX5;
+
     // Enable ADC, we leave start conversion alone first (activate later on) 
     ADCSRA |= 0b10000000;   
 
     // Disable auto trigger ~(0b00100000) is 0b11011111
-    // We leave interrupt flag, interrupt enable and prescalar alone
+    // We leave interrupt flag and interrupt enable alone, setupTiming() sets the prescaler
     ADCSRA &= 0b11011111; 
-        
+
+    // The bandgap needs time to settle from now
+    if (switched) { startSettling(); }
+
+    #if MCUVOLTAGE_STATS
+      stats.setups++;
+    #endif
+
+    return true;
   }
   
   // Read the ADC value of bandgap against Vcc
-  unsigned int MCUVoltage::readADC()
+  unsigned long MCUVoltage::convertOnce()
   {
     
     ADCSRA |= 0b01000000; // Start the conversion
@@ -157,10 +382,16 @@ MCUVoltage::MCUVoltage(unsigned int myBandgap)
     // When Bit 6 (ADSC) becomes 0, the conversion is completed
     while((ADCSRA & 0b01000000) > 0){} 
   
-    lastADCReading = ADCL; // Must read ADCL first
-    lastADCReading |= ADCH<<8; // Shift 8 bits to the left and add on to value
+    unsigned int reading = ADCL; // Must read ADCL first
+    reading |= ADCH<<8; // Shift 8 bits to the left and add on to value
   
-    return lastADCReading;
+    return reading;
+  }
+
+  void MCUVoltage::disableADCInterrupt()
+  {
+    // Clear ADIE ~(0b00001000) is 0b11110111
+    ADCSRA &= 0b11110111;
   }
 #endif
 
@@ -168,8 +399,60 @@ MCUVoltage::MCUVoltage(unsigned int myBandgap)
 /*================================================================================*/
 
 
+// Setup the ADC to read the bandgap against Vcc.
+// Returns true if the ADC had to be set up, false if it already was.
+bool MCUVoltage::ADCSetup()
+{
+  // Temperature first, it needs the ADC too
+  refreshTemperature();
+
+  return setupRegisters();
+}
+
+
+/*================================================================================*/
+
+
+// Read the ADC value of bandgap against Vcc
+unsigned int MCUVoltage::readADC()
+{
+  // lastADCReading enough to hold all of RESULT
+  lastADCReading = convert();
+
+  return lastADCReading;
+}
+
+
+/*================================================================================*/
+
+
+// Do one conversion, with the CPU asleep if noise reduction is on
+unsigned long MCUVoltage::convert()
+{
+  #if MCUVOLTAGE_STATS
+
+    unsigned long start = micros();
+    unsigned long reading = noiseReduction ? sleepConversion() : convertOnce();
+
+    countConversion(mode, reading, micros() - start);
+
+    return reading;
+
+  #else
+
+    if (noiseReduction) { return sleepConversion(); }
+
+    return convertOnce();
+
+  #endif
+}
+
+
+/*================================================================================*/
+
+
 // Read Vcc with once only.
-// Recommend to use the averaging method as it throws away the first reading.
+// Recommend to use the averaging method as it throws away readings until the bandgap settles.
 unsigned long MCUVoltage::readmV()
 {
   mode = REGULAR_READING;
@@ -184,7 +467,7 @@ unsigned long MCUVoltage::readmV()
 
 
 // Read Vcc many times and average the readings. 
-// One reading is thrown away before averaging.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
 unsigned long MCUVoltage::readmV(byte avgTimes)
 {
   mode = REGULAR_READING; 
@@ -193,10 +476,9 @@ unsigned long MCUVoltage::readmV(byte avgTimes)
   if (avgTimes <1){ avgTimes=1; }
 
   // Setup before reading ADC
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
   ADCSetup();
-
-  // Throw away first reading
-  readADC();
+  settle();
   
   unsigned long ADCReadings = 0;
 
@@ -284,10 +566,16 @@ bool MCUVoltage::setBandgap(unsigned int myBandgap)
 {
   // Bandgap cannot be zero.
   // Purposely set to 0 in the case of non-parameter constructor
-  // to use defauly bandgap values
-  if (myBandgap>0)
+  // to use defauly bandgap values.
+  // Kept with 3 fraction bits in 16 bits, so at most 8191mV.
+  if (myBandgap>0 && myBandgap < (65536UL >> fractionBits_Calibration))
   {
-    bandgap=myBandgap;
+    bandgap = myBandgap;
+
+    // Values used for conversion must follow the bandgap, any calibration is dropped
+    setCalibration(myBandgap << fractionBits_Calibration, 0);
+    calibrated = false;
+
     return true;
   }
 
@@ -316,44 +604,349 @@ byte MCUVoltage::getDevice()
 /*================================================================================*/
 
 
-// Math power function but for integers only
-unsigned long MCUVoltage::intPow(byte base, byte exponent)
+// This will use the precomputed value to calculated VCC in millivoltes
+unsigned long MCUVoltage::convertToVcc(unsigned long ADCReading)
+{
+  if (fastConversion) { return addOffset(reciprocalVcc(bandgap_Compensated, bitDepth - fractionBits_Calibration, ADCReading)); }
+
+  // Math time!
+  // Vbg/Vcc = ADCReading/1024
+  // Vcc = (Vbg*1024)/ADCReading
+  // (Vbg*1024) already precomputed    
+  return addOffset(precompValue/ADCReading);
+
+}
+
+
+/*================================================================================*/
+
+
+// This will do the equation for a reading of any bit depth
+unsigned long MCUVoltage::convertToVcc(unsigned long ADCReading, byte readingBitDepth)
 {
-  unsigned long result=1;
-  for (byte i=0; i<exponent; i++)
+  // The bandgap has fraction bits, take them off the bit depth
+  byte shift = readingBitDepth - fractionBits_Calibration;
+
+  if (fastConversion) { return addOffset(reciprocalVcc(bandgap_Compensated, shift, ADCReading)); }
+
+  // Math time!
+  // Vbg/Vcc = ADCReading/resolution
+  // Vcc = (Vbg*resolution)/ADCReading
+  return addOffset(((unsigned long)bandgap_Compensated << shift)/ADCReading);
+}
+
+
+/*================================================================================*/
+
+
+// 1/x for x from 1 to 2 in 128 steps, as round(2^23/(128+i)) - 32768 to fit in 16 bits
+static const unsigned int reciprocalTable[129] PROGMEM =
+{
+  32768, 32260, 31760, 31267, 30782, 30304, 29834, 29370,
+  28913, 28463, 28019, 27582, 27151, 26726, 26307, 25894,
+  25486, 25084, 24688, 24297, 23912, 23531, 23156, 22786,
+  22420, 22060, 21703, 21352, 21005, 20663, 20324, 19991,
+  19661, 19335, 19014, 18696, 18382, 18072, 17766, 17463,
+  17164, 16869, 16577, 16288, 16003, 15721, 15442, 15167,
+  14895, 14625, 14359, 14096, 13835, 13578, 13323, 13071,
+  12822, 12576, 12332, 12091, 11852, 11616, 11383, 11151,
+  10923, 10696, 10472, 10251, 10031, 9814, 9599, 9386,
+  9175, 8966, 8760, 8555, 8353, 8152, 7953, 7757,
+  7562, 7369, 7178, 6988, 6801, 6615, 6431, 6249,
+  6068, 5889, 5712, 5536, 5362, 5190, 5019, 4849,
+  4681, 4515, 4350, 4186, 4024, 3863, 3704, 3546,
+  3390, 3235, 3081, 2928, 2777, 2627, 2478, 2331,
+  2185, 2040, 1896, 1753, 1612, 1471, 1332, 1194,
+  1057, 921, 786, 653, 520, 389, 258, 129,
+  0
+};
+
+
+// Vcc = bandgap*2^readingBitDepth/ADCReading in millivolts, without any division.
+// 32 bit division on AVR is done bit by bit in software and takes several hundred cycles,
+// instead we look up 1/ADCReading and multiply. Rounded, within 1mV of the exact result.
+unsigned long MCUVoltage::reciprocalVcc(unsigned int myBandgap, byte readingBitDepth, unsigned long ADCReading)
+{
+  if (ADCReading == 0) { return 0; }
+
+  // Normalise, so ADCReading = m * 2^shift with m between 2^15 and 2^16
+  signed char shift = 0;
+  unsigned long m = ADCReading;
+  
+  while (m >= 65536UL) { m >>= 1; shift++; }
+  while (m < 32768UL) { m <<= 1; shift--; }
+
+  // Top 7 bits after the leading 1 pick the table entry, the next 8 bits interpolate
+  byte index = (m >> 8) & 0b01111111;
+  byte fraction = m;
+
+  unsigned int r0 = pgm_read_word(&reciprocalTable[index]);
+  unsigned int r1 = pgm_read_word(&reciprocalTable[index+1]);
+
+  // r is 2^31/m, between 2^15 and 2^16
+  unsigned long r = 32768UL + r0 - (((unsigned long)(r0 - r1) * fraction) >> 8);
+
+  // Vcc = bandgap*2^readingBitDepth/(m*2^shift) = bandgap*r/2^(31 + shift - readingBitDepth)
+  signed char rightShift = 31 + shift - readingBitDepth;
+
+  // Only for readings too small to be real, the shift would go the wrong way
+  if (rightShift <= 0) { return ((unsigned long)myBandgap << readingBitDepth) / ADCReading; }
+
+  // Bandgap is at most 16 bits and r at most 2^16, so this always fits
+  unsigned long product = (unsigned long)myBandgap * r;
+
+  // Add half before shifting to round
+  return (product + (1UL << (rightShift - 1))) >> rightShift;
+}
+
+
+/*================================================================================*/
+
+
+// Convert lastADCReading to Vcc using the resolution of the current mode
+unsigned long MCUVoltage::convertLastReading()
+{
+  switch (mode)
   {
-    result*=(unsigned long)base;
+    case SOFTWARE_OVERSAMPLING:
+      return convertToVcc(lastADCReading, bitDepth_OS);
+
+    #if MCUVOLTAGE_HWOS
+    case HARDWARE_OVERSAMPLING:
+      return convertToVcc(lastADCReading, bitDepth_HWOS);
+    #endif
+
+    default:
+      return convertToVcc(lastADCReading);
   }
+}
+
+
+/*================================================================================*/
+
 
-  return result;
+// Convert an ADC reading of any bit depth to Vcc in millivolts, with the current bandgap
+unsigned long MCUVoltage::convertTomV(unsigned long ADCReading, byte readingBitDepth)
+{
+  return convertToVcc(ADCReading, readingBitDepth);
 }
 
 
 /*================================================================================*/
 
 
-// This will use the precomputed value to calculated VCC in millivoltes
-unsigned long MCUVoltage::convertToVcc(unsigned long ADCReading)
+// Millivolts to volts in Q16.16 fixed point (volts times 65536), rounded.
+// The integer part is the top 16 bits and the fraction the bottom 16 bits.
+unsigned long MCUVoltage::convertToQ16(unsigned long mV)
 {
-  // Math time!
-  // Vbg/Vcc = ADCReading/1024
-  // Vcc = (Vbg*1024)/ADCReading
-  // (Vbg*1024) already precomputed    
-  return precompValue/ADCReading;
+  // mV*65536 would overflow above 65535mV, split into whole volts and the rest
+  unsigned long volts = mV / 1000;
+  unsigned int  rest = mV - volts * 1000;
 
+  return (volts << 16) + (((unsigned long)rest << 16) + 500) / 1000;
 }
 
 
 /*================================================================================*/
 
 
-// This will do the equation using all the variables
-unsigned long MCUVoltage::convertToVcc(unsigned int bandgap, unsigned long resolution, unsigned long ADCReading)
+// Powers of 10 for formatmV(), largest first
+static const unsigned long powersOf10[10] PROGMEM =
 {
-  // Math time!
-  // Vbg/Vcc = ADCReading/resolution
-  // Vcc = (Vbg*resolution)/ADCReading
-  return ((unsigned long)bandgap*resolution)/ADCReading;
+  1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+  10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+
+// Write mV as volts with the given decimals (0 to 3, rounded), e.g. 4987 as "4.987",
+// and a null at the end. buffer must hold MCUVOLTAGE_FORMAT_SIZE characters.
+// Returns the number of characters written, without the null.
+// No float and no division, every digit is found by subtracting powers of 10.
+byte MCUVoltage::formatmV(unsigned long mV, char* buffer, byte decimals)
+{
+  if (decimals > 3) { decimals = 3; }
+
+  // Round off the decimals not shown, without going past the top
+  byte dropped = 3 - decimals;
+  unsigned long half = pgm_read_dword(&powersOf10[9 - dropped]) / 2;
+  if (mV <= 0xFFFFFFFFUL - half) { mV += half; }
+
+  byte length = 0;
+
+  for (byte i=0; i<10 - dropped; i++)
+  {
+    unsigned long power = pgm_read_dword(&powersOf10[i]);
+    char digit = '0';
+
+    while (mV >= power)
+    {
+      mV -= power;
+      digit++;
+    }
+
+    // Point after the volts, which are the digits down to the thousands
+    if (i == 7 && decimals > 0)
+    {
+      if (length == 0) { buffer[length++] = '0'; }
+      buffer[length++] = '.';
+    }
+
+    // Skip leading zeros of the volts, but always keep the ones digit
+    if (length > 0 || digit != '0' || i >= 6) { buffer[length++] = digit; }
+  }
+
+  buffer[length] = '\0';
+
+  return length;
+}
+
+
+/*================================================================================*/
+
+
+// Choose between the division free conversion (default) and the exact division
+void MCUVoltage::setFastConversion(bool enable)
+{
+  fastConversion = enable;
+}
+
+
+/*================================================================================*/
+
+
+bool MCUVoltage::getFastConversion()
+{
+  return fastConversion;
+}
+
+
+/*================================================================================*/
+
+
+// Get ready to accumulate readings for a non-blocking reading in the current mode
+void MCUVoltage::resetAccumulator(bool settleFirst, byte avgTimes)
+{
+  // Min averaging times is 1
+  if (avgTimes <1){ avgTimes=1; }
+
+  settleFirst_Async = settleFirst;
+  avgTimes_Async = avgTimes;
+  avgCount_Async = avgTimes;
+  sampleCount_Async = sampleCount_OS;
+  sumOfSamples_Async = 0;
+  sumOfAvg_Async = 0;
+
+  #if MCUVOLTAGE_HWOS
+    // Hardware accumulations to add up before decimating
+    if (mode == HARDWARE_OVERSAMPLING) { sampleCount_Async = bursts_HWOS; }
+  #endif
+}
+
+
+/*================================================================================*/
+
+
+// Add one reading to a non-blocking reading in the current mode, discarded readings excluded.
+// Returns true when all readings are in, with the averaged result in lastADCReading.
+bool MCUVoltage::accumulateReading(unsigned long reading)
+{
+  if (mode == SOFTWARE_OVERSAMPLING)
+  {
+    sumOfSamples_Async += reading;
+
+    // Still need more samples to oversample
+    if (--sampleCount_Async > 0) { return false; }
+
+    // Decimate, then get ready for the next set of samples
+    reading = sumOfSamples_Async >> extraBits_OS;
+    sumOfSamples_Async = 0;
+    sampleCount_Async = sampleCount_OS;
+  }
+
+  #if MCUVOLTAGE_HWOS
+
+    else if (mode == HARDWARE_OVERSAMPLING)
+    {
+      sumOfSamples_Async += reading;
+
+      // Still need more bursts, past 17 bits on the ATtiny3224/3226/3227
+      if (--sampleCount_Async > 0) { return false; }
+
+      // Decimate, a 16 bits result on the ATtiny3224/3226/3227 is hardware scaled and not shifted
+      reading = sumOfSamples_Async >> shift_HWOS;
+      sumOfSamples_Async = 0;
+      sampleCount_Async = bursts_HWOS;
+    }
+
+  #endif
+
+  sumOfAvg_Async += reading;
+
+  // Still need more readings to average
+  if (--avgCount_Async > 0) { return false; }
+
+  lastADCReading = sumOfAvg_Async / avgTimes_Async;
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// True when the last non-blocking reading is completed
+bool MCUVoltage::isReady()
+{
+  return ready;
+}
+
+
+/*================================================================================*/
+
+
+// True while a non-blocking reading is using the ADC
+bool MCUVoltage::isBusy()
+{
+  return busy;
+}
+
+
+/*================================================================================*/
+
+
+// Abandon the non-blocking reading in progress
+void MCUVoltage::stopReading()
+{
+  // Background sampler and watching are stopped with stopSampling() and stopWatching()
+  if (activeInstance != this || sampling || watching) { return; }
+
+  // Stop the ISR from starting another conversion
+  disableADCInterrupt();
+  activeInstance = NULL;
+  stepping = false;
+  busy = false;
+}
+
+
+/*================================================================================*/
+
+
+// Returns Vcc of the last completed non-blocking reading in millivolts, 0 if none
+unsigned long MCUVoltage::getmV()
+{
+  if (!ready) { return 0; }
+
+  return convertLastReading();
+}
+
+
+/*================================================================================*/
+
+
+// Set the function to call when a non-blocking reading completes, NULL to remove.
+// This is called from inside the ISR, so keep it short.
+void MCUVoltage::setCallback(MCUVoltageCallback myCallback)
+{
+  callback = myCallback;
 }
 
 
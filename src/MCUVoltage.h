@@ -20,6 +20,169 @@
 #ifndef MCUVOLTAGE_H
 #define MCUVOLTAGE_H
 
+// Number of raw samples the background sampler can hold, must be a power of 2 and at most 128
+#ifndef MCUVOLTAGE_BUFFER_SIZE
+  #define MCUVOLTAGE_BUFFER_SIZE 32
+#endif
+
+// The ring buffer wraps its byte indices around with a mask, anything else corrupts it
+static_assert(MCUVOLTAGE_BUFFER_SIZE >= 2 && (MCUVOLTAGE_BUFFER_SIZE & (MCUVOLTAGE_BUFFER_SIZE - 1)) == 0 &&
+              MCUVOLTAGE_BUFFER_SIZE <= 128, "MCUVOLTAGE_BUFFER_SIZE must be a power of 2 from 2 to 128");
+
+// Most samples streamSamples() puts in one frame, at most 80 so a frame fits in 255 bytes
+#ifndef MCUVOLTAGE_STREAM_FRAME_SIZE
+  #define MCUVOLTAGE_STREAM_FRAME_SIZE 16
+#endif
+
+static_assert(MCUVOLTAGE_STREAM_FRAME_SIZE >= 1 && MCUVOLTAGE_STREAM_FRAME_SIZE <= 80,
+              "MCUVOLTAGE_STREAM_FRAME_SIZE must be from 1 to 80");
+
+// Timer used by setSamplingRate() on the ATtiny3224/3226/3227, 0 for TCB0 or 1 for TCB1
+#ifndef MCUVOLTAGE_SAMPLING_TCB
+  #define MCUVOLTAGE_SAMPLING_TCB 0
+#endif
+
+// Number of readings runQueue() can hold
+#ifndef MCUVOLTAGE_QUEUE_SIZE
+  #define MCUVOLTAGE_QUEUE_SIZE 8
+#endif
+
+// Largest window of the median, trimmed mean and Hampel filters, at most 7
+#ifndef MCUVOLTAGE_FILTER_SIZE
+  #define MCUVOLTAGE_FILTER_SIZE 7
+#endif
+
+// Set to 0 so the constructor does not load the calibration saved by saveCalibration()
+#ifndef MCUVOLTAGE_LOAD_CALIBRATION
+  #define MCUVOLTAGE_LOAD_CALIBRATION 1
+#endif
+
+// Bytes saveCalibration() writes to the EEPROM
+#define MCUVOLTAGE_CALIBRATION_SIZE 6
+
+// EEPROM address saveCalibration() writes to, the last bytes of the EEPROM by default
+#ifndef MCUVOLTAGE_CALIBRATION_ADDRESS
+  #define MCUVOLTAGE_CALIBRATION_ADDRESS (E2END + 1 - MCUVOLTAGE_CALIBRATION_SIZE)
+#endif
+
+// Buffer size formatmV() needs for any unsigned long, "4294967.295" and the null
+#define MCUVOLTAGE_FORMAT_SIZE 12
+
+// Set to 1 to count conversions, discarded readings, setups and busy-wait time, see getStats()
+#ifndef MCUVOLTAGE_STATS
+  #define MCUVOLTAGE_STATS 0
+#endif
+
+// 1 for the ADC of the tinyAVR 0/1-series, megaAVR 0-series and AVR Dx, which has a 16 bit RES
+// register and accumulates up to 64 samples (SAMPNUM). Picked by the registers in the io.h of the device.
+#if defined(ADC_STCONV_bm) && defined(ADC_SAMPNUM_gm)
+  #define MCUVOLTAGE_SAMPNUM_ADC 1
+#else
+  #define MCUVOLTAGE_SAMPNUM_ADC 0
+#endif
+
+// 1 if the ADC can accumulate samples by itself, see ADCSetup_HWOS()
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+  #define MCUVOLTAGE_HWOS 1
+#else
+  #define MCUVOLTAGE_HWOS 0
+#endif
+
+// 1 if the ADC has a PGA and differential inputs for the zoomed readings, see readuV_Zoom()
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+  #define MCUVOLTAGE_ZOOM 1
+#else
+  #define MCUVOLTAGE_ZOOM 0
+#endif
+
+// Microseconds the bandgap needs to settle after the ADC is set up,
+// readings are thrown away for at least this long
+#ifndef MCUVOLTAGE_SETTLE_US
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+    #define MCUVOLTAGE_SETTLE_US 50
+  #else
+    #define MCUVOLTAGE_SETTLE_US 70
+  #endif
+#endif
+
+// Readings after the first that must all be within 1 step of it before the bandgap counts as settled
+// early, so a bandgap still creeping up one step at a time is not taken as settled
+#ifndef MCUVOLTAGE_SETTLE_MATCHES
+  #define MCUVOLTAGE_SETTLE_MATCHES 3
+#endif
+
+// Microseconds the reference needs to settle before the temperature sensor is read.
+// On the ATmega the internal reference charges the capacitor on AREF, which is slow.
+#ifndef MCUVOLTAGE_TEMPERATURE_SETTLE_US
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+    #define MCUVOLTAGE_TEMPERATURE_SETTLE_US 50
+  #else
+    #define MCUVOLTAGE_TEMPERATURE_SETTLE_US 2000
+  #endif
+#endif
+
+// 1 if the MCU has an internal temperature sensor, the ATmega640/1280/1281/2560/2561 do not
+#if defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) || \
+    defined(__AVR_ATmega1281__) || defined(__AVR_ATmega2560__) || defined(__AVR_ATmega2561__)
+  #define MCUVOLTAGE_TEMPERATURE_SENSOR 0
+#else
+  #define MCUVOLTAGE_TEMPERATURE_SENSOR 1
+#endif
+
+// Native ADC and default bandgap, known at compile time
+// 12 Bit ADC, default 1.024V reference for ATtiny3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+  #define MCUVOLTAGE_BANDGAP 1024
+  #define MCUVOLTAGE_BIT_DEPTH 12
+
+// 12 Bit ADC, DACREF0 from the 1.024V reference for AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC && defined(VREF_ADC0REF)
+  #define MCUVOLTAGE_BANDGAP 1024
+  #define MCUVOLTAGE_BIT_DEPTH 12
+
+// 10 Bit ADC, 1.1V bandgap for the others (eg Uno, Nano Every, ATtiny1614)
+#else
+  #define MCUVOLTAGE_BANDGAP 1100
+  #define MCUVOLTAGE_BIT_DEPTH 10
+#endif
+
+// Compile time specialised front end, see MCUVoltageT.h
+template <byte TargetBitDepth, byte AvgTimes, unsigned int Bandgap> class MCUVoltageT;
+
+// Function called when a non-blocking reading completes, Vcc is passed in millivolts
+typedef void (*MCUVoltageCallback)(unsigned long mV);
+
+// A reading waiting for runQueue(), either of an analog pin or of Vcc
+class MCUVoltage;
+struct MCUVoltageRequest
+{
+  MCUVoltage*    instance;  // Reads Vcc if not NULL
+  byte           pin;
+  byte           reference; // As passed to analogReference()
+  byte           avgTimes;
+  unsigned int*  reading;   // Result of analogRead(pin)
+  unsigned long* mV;        // Result of Vcc
+};
+
+// One point of a battery discharge curve, kept in PROGMEM, see setBattery()
+struct MCUVoltageBatteryPoint
+{
+  unsigned int mV;
+  byte         percent;
+};
+
+// Counters kept when MCUVOLTAGE_STATS is 1, shared by all instances as there is only one ADC
+struct MCUVoltageStats
+{
+  unsigned long conversions[3]; // Indexed by the mode, REGULAR_READING, SOFTWARE_OVERSAMPLING or HARDWARE_OVERSAMPLING
+  unsigned long discarded;      // Readings thrown away while the bandgap settles
+  unsigned long setups;         // Times the ADC registers had to be set up
+  unsigned long busyMicros;     // Microseconds spent waiting on blocking conversions
+  unsigned long minRaw;         // Smallest, largest and last raw result of any conversion
+  unsigned long maxRaw;
+  unsigned long lastRaw;
+};
+
 class MCUVoltage
 { 
   // Definitions
@@ -32,35 +195,73 @@ class MCUVoltage
   #define A_LEO 2
   #define A_MEGA 3
   #define ATTINY322X 4
+  #define TINYAVR_01 5
+  #define MEGAAVR_0 6
+  #define AVR_DX 7
+
+  #define TIMING_UNCHANGED 0
+  #define TIMING_FAST 1
+  #define TIMING_BALANCED 2
+  #define TIMING_PRECISE 3
+
+  #define FILTER_NONE 0
+  #define FILTER_EMA 1
+  #define FILTER_MEDIAN 2
+  #define FILTER_TRIMMED 3
+  #define FILTER_HAMPEL 4
+
+  #define BATTERY_LIION 1
+  #define BATTERY_ALKALINE_2 2
+  #define BATTERY_NIMH_3 3
+  #define BATTERY_COIN 4
+
+  // The template shares the register level methods
+  template <byte TargetBitDepth, byte AvgTimes, unsigned int Bandgap> friend class MCUVoltageT;
 
   private:
 
-  // 12 Bit ADC, default 1.024V reference for ATtiny3224/3226/3227
-  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
-  
-    unsigned int        bandgap = 1024;
-    const byte          bitDepth = 12; //12 bit ADC
-    const unsigned int  resolution = 4096; 
+    // Static so they take no SRAM in every instance
+    static const byte          bitDepth = MCUVOLTAGE_BIT_DEPTH;
+    static const unsigned int  resolution = 1U << MCUVOLTAGE_BIT_DEPTH;
+    unsigned int               bandgap = MCUVOLTAGE_BANDGAP;
+
+  // ATtiny3224/3226/3227, tinyAVR 0/1-series, megaAVR 0-series and AVR Dx only
+  #if MCUVOLTAGE_HWOS
 
     // Hardware oversampling 
     byte          bitDepth_HWOS = 0 ;
     unsigned long resolution_HWOS = 0; 
     byte          extraBits_HWOS = 0;
-    
-    const byte minBD_HWOS = 13; // Hardware over sample to at least 13 bits
-    const byte maxBD_HWOS = 17; // and at most 17 bits
-    const byte defaultBD_HWOS = 16; // Defaults to 16 bit hwos
+    byte          shift_HWOS = 0; // Bits the result is shifted right by to decimate
+    byte          bursts_HWOS = 1; // Hardware accumulations added up in software for every reading
 
+  #endif
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+    static const byte minBD_HWOS = 13; // Hardware over sample to at least 13 bits
+    static const byte maxBD_HWOS = 20; // and at most 20 bits, past 17 bits with bursts of 1024 samples added up
+    static const byte defaultBD_HWOS = 16; // Defaults to 16 bit hwos
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    // 4, 16 or 64 samples, RES has 16 bits for all of them
+    static const byte minBD_HWOS = MCUVOLTAGE_BIT_DEPTH + 1; // Hardware over sample to at least 1 extra bit
+    static const byte maxBD_HWOS = MCUVOLTAGE_BIT_DEPTH + 3; // and at most 3 extra bits
+    static const byte defaultBD_HWOS = MCUVOLTAGE_BIT_DEPTH + 3; // Defaults to the most
+
+  #endif
+
+  #if MCUVOLTAGE_ZOOM
+
+    // Zoom, Vcc/10 against DACREF0 at the operating point, through the PGA
+    byte          gain_Zoom = 0; // 1, 2, 4, 8 or 16, 0 until an operating point is set
+    byte          dacref_Zoom = 0;
+    bool          inWindow_Zoom = false;
+    bool          centre_Zoom(unsigned long centremV);
+    bool          setupRegisters_Zoom();
+    unsigned long convertToVcc_Zoom(long sumOfReadings, byte count);
 
-  // 10 Bit ADC for the others (eg Uno)
-  // 1.1V reference for ATmega16u4/32u4, 48/88/168/328 and their 'P' versions,
-  // 640/1280/1281/2560/2561
-  #else
-  
-    unsigned int        bandgap = 1100;
-    const byte          bitDepth = 10; //10 bit ADC
-    const unsigned int  resolution = 1024;
-    
   #endif
 
     // Common Private Variables
@@ -70,13 +271,173 @@ class MCUVoltage
     unsigned long resolution_OS = 0;
     unsigned int  sampleCount_OS = 0;
     byte          mode = REGULAR_READING;
+    byte          avgTimes_Adaptive = 0;
     byte          device = UNKNOWN_DEVICE;
     
+    // Calibration
+    // Vcc = bandgap_Compensated*2^(readingBitDepth - fractionBits_Calibration)/reading + offset_Calibration,
+    // the gain is folded into the bandgap so a calibrated reading costs the same.
+    // bandgap_Compensated is bandgap_Calibration moved by the temperature compensation.
+    static const byte fractionBits_Calibration = 3;
+    unsigned int      bandgap_Calibration = (unsigned int)MCUVOLTAGE_BANDGAP << fractionBits_Calibration;
+    int               offset_Calibration = 0;
+    bool              calibrated = false;
+    unsigned int      bandgap_Compensated = (unsigned int)MCUVOLTAGE_BANDGAP << fractionBits_Calibration;
+    void              setCalibration(unsigned int myBandgap, int myOffset);
+    unsigned long     addOffset(unsigned long mV);
+
+    // CRC-8 (polynomial 0x07), of the calibration saved and of the streamed frames
+    static byte       crc8(const byte* data, byte length);
+    unsigned long     convertToReading(unsigned long mV, byte readingBitDepth);
+
+    // Temperature Compensation Variables
+    // The temperature is shared since there is only one sensor, each instance follows it with its bandgap
+    static int           temperature;
+    static unsigned long temperatureMillis;
+    static bool          temperatureKnown;
+    int                  tempco_Temperature = 0;
+    int                  reference_Temperature = 25;
+    unsigned long        refresh_Temperature = 0;
+    int                  used_Temperature = -32768; // Temperature the bandgap follows, none yet
+
+    // Temperature Compensation Private Methods
+    void                 refreshTemperature();
+    void                 compensate();
+
     // Common Private Methods
     unsigned long precompValue;
-    unsigned long intPow(byte base, byte exponent);
+    bool          fastConversion = true;
     unsigned long convertToVcc(unsigned long ADCReading);
-    unsigned long convertToVcc(unsigned int bandgap, unsigned long resolution, unsigned long ADCReading);
+    unsigned long convertToVcc(unsigned long ADCReading, byte readingBitDepth);
+    static unsigned long reciprocalVcc(unsigned int myBandgap, byte readingBitDepth, unsigned long ADCReading);
+    unsigned long convertLastReading();
+    unsigned long averageAdaptive(byte readingBitDepth, byte tolerancemV, byte maxAvgTimes);
+
+    // Non-blocking Reading Variables
+    // Only one reading can use the ADC at a time, the ISR serves this instance
+    static MCUVoltage* volatile activeInstance;
+    volatile bool          busy = false;
+    volatile bool          ready = false;
+    volatile bool          sampling = false;
+    bool                   stepping = false;
+    unsigned long          conversionCount_Step = 0;
+    unsigned long          conversionTotal_Step = 0;
+    volatile bool          settleFirst_Async = false;
+    volatile byte          avgCount_Async = 0;
+    volatile unsigned int  sampleCount_Async = 0;
+    volatile unsigned long sumOfSamples_Async = 0;
+    volatile unsigned long sumOfAvg_Async = 0;
+    byte                   avgTimes_Async = 1;
+    MCUVoltageCallback     callback = NULL;
+
+    // Non-blocking Reading Private Methods
+    void resetAccumulator(bool settleFirst, byte avgTimes);
+    bool accumulateReading(unsigned long reading);
+    bool beginAsync(bool settleFirst, byte avgTimes);
+    bool stepOnce();
+    byte getProgress();
+    static void startConversion();
+    static void enableADCInterrupt(); // With the ISR, only linked in when needed
+    static void disableADCInterrupt();
+    void processConversion();
+
+    // Register level, shared with MCUVoltageT
+    static bool          setupRegisters();
+    #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+      static bool        setupRegisters(byte myCTRLF, byte myCOMMAND);
+    #elif MCUVOLTAGE_SAMPNUM_ADC
+      static bool        setupRegisters(byte mySAMPNUM);
+    #endif
+    static unsigned long convertOnce();
+
+    // ADC Timing
+    // Shared since there is only one ADC
+    static byte          timing;
+    static void          setupTiming();
+    static byte          settlingConversions();
+    void                 settle();
+
+    // Bandgap Settling
+    // Set when the reference or mux is switched, cleared once the bandgap has settled
+    static volatile bool settling;
+    static volatile byte settleCount;
+    static unsigned long switchMicros;
+    static unsigned long settleReading;
+    static volatile byte settleMatches;
+    static void          startSettling();
+    static bool          isSettling();
+    static void          discardSettling(unsigned long reading);
+
+    // ADC Noise Reduction
+    // Conversion with the CPU asleep. convert() calls it through a pointer set by
+    // setNoiseReduction(), so sketches that never turn it on do not link in the
+    // sleep code or the ADC interrupt (see MCUVoltage_Interrupt.cpp)
+    bool                 noiseReduction = false;
+    static volatile bool asleep;
+    static unsigned long (*sleepConversion)();
+    static unsigned long convertSleeping();
+    unsigned long        convert();
+
+    // Vcc Threshold Variables
+    // Thresholds are ADC readings, the CPU only compares (ATmega) or not at all (ATtiny3224/3226/3227)
+    volatile bool      watching = false;
+    unsigned long      lowThreshold_Watch = 0;
+    unsigned long      highThreshold_Watch = 0;
+    MCUVoltageCallback callback_Watch = NULL;
+
+    // Vcc Threshold Private Methods
+    static void startWatching(byte windowMode);
+    static void endWatching();
+    void        windowLeft(unsigned long reading);
+
+    // Streaming Filter Variables
+    byte          filter_Filter = FILTER_NONE;
+    byte          strength_Filter = 0;
+    bool          started_Filter = false;
+    byte          index_Filter = 0;
+    unsigned long sum_Filter = 0;
+    unsigned int  window_Filter[MCUVOLTAGE_FILTER_SIZE];
+
+    // Battery Variables
+    const MCUVoltageBatteryPoint* curve_Battery = NULL;
+    byte                          count_Battery = 0;
+
+    // Background Sampler Variables
+    // Single producer (ISR) single consumer (user) ring buffer, shared since there is only one ADC
+    static volatile unsigned int sampleBuffer[MCUVOLTAGE_BUFFER_SIZE];
+    static volatile byte         sampleHead;
+    static volatile byte         sampleTail;
+    static volatile unsigned int droppedSamples;
+
+    // Timed sampling, Timer1 (ATmega) or a TCB (ATtiny3224/3226/3227) starts the conversions
+    static unsigned long         samplingRate;
+    static unsigned int          samplingTop;
+    static byte                  samplingClock;
+
+    // Background Sampler Private Methods
+    void        pushSample(unsigned int sample);
+    static void startSamplingTimer();
+    static void stopSamplingTimer();
+
+    // Binary Streaming Variables
+    // Shared like the buffer it drains, both start again on every beginSampling()
+    static byte         sequence_Stream;
+    static unsigned int dropped_Stream;
+
+    // Binary Streaming Private Methods
+    void        writeHeader_Stream(Print& output);
+
+    // ADC Sharing Variables
+    // One queue, shared since there is only one ADC
+    static MCUVoltageRequest queue[MCUVOLTAGE_QUEUE_SIZE];
+    static byte              queueLength;
+    static byte              queueReference;
+
+    // Instrumentation
+    #if MCUVOLTAGE_STATS
+      static MCUVoltageStats stats;
+      static void            countConversion(byte myMode, unsigned long reading, unsigned long busyMicros);
+    #endif
 
 
         
@@ -87,12 +448,13 @@ class MCUVoltage
     MCUVoltage(unsigned int myBandgap);
 
     // Regular Readings
-    void          ADCSetup();
+    bool          ADCSetup();
     unsigned int  readADC();
     unsigned long readmV();
     unsigned long readmV(byte avgTimes);
     float         read();
     float         read(byte avgTimes);
+    unsigned long readmV_Adaptive(byte tolerancemV, byte maxAvgTimes);
     
     // Regular Reading Getters and Setters
     unsigned long getLastADCReading();
@@ -101,32 +463,141 @@ class MCUVoltage
     unsigned int  getResolution();
     byte          getMode();
     byte          getDevice();
+    byte          getAvgTimes_Adaptive();
     bool          setBandgap(unsigned int myBandgap);
 
+    // ADC Noise Reduction
+    void          setNoiseReduction(bool enable);
+    bool          getNoiseReduction();
+
+    // ADC Timing
+    bool          setTiming(byte profile);
+    byte          getTiming();
+    static unsigned long getConversionsPerSecond();
+
+    // Conversion
+    unsigned long convertTomV(unsigned long ADCReading, byte readingBitDepth);
+    static unsigned long convertToQ16(unsigned long mV);
+    static byte   formatmV(unsigned long mV, char* buffer, byte decimals = 3);
+    void          setFastConversion(bool enable);
+    bool          getFastConversion();
+
     // Software Oversampled Readings
-    void          ADCSetup_OS(byte targetBitDepth);
+    bool          ADCSetup_OS(byte targetBitDepth);
     unsigned long readADC_OS();
     unsigned long readmV_OS(byte targetBitDepth);
     unsigned long readmV_OS(byte targetBitDepth, byte avgTimes);
     float         read_OS(byte targetBitDepth);
     float         read_OS(byte targetBitDepth, byte avgTimes);
+    unsigned long readmV_OS_Adaptive(byte targetBitDepth, byte tolerancemV, byte maxAvgTimes);
     
     // Software Oversampling Getters and Setters
     byte          getBitDepth_OS();
     unsigned long getResolution_OS();
     byte          getExtraBits_OS();
     unsigned int  getSampleCount_OS();
+
+    // Streaming Filters
+    bool          setFilter(byte filter, byte strength);
+    void          resetFilter();
+    byte          getFilter();
+    byte          getStrength_Filter();
+    unsigned long readmV_Filtered();
+    unsigned long filtermV(unsigned int ADCReading);
+
+    // Calibration
+    bool          calibrate(unsigned long measuredmV, unsigned long actualmV);
+    bool          calibrate(unsigned long measuredmV1, unsigned long actualmV1, unsigned long measuredmV2, unsigned long actualmV2);
+    void          clearCalibration();
+    bool          isCalibrated();
+    int           getOffset_Calibration();
+    void          saveCalibration();
+    bool          loadCalibration();
+
+    // Temperature Compensation, only if the MCU has a temperature sensor
+    #if MCUVOLTAGE_TEMPERATURE_SENSOR
+      static int    readTemperature();
+      static int    getTemperature();
+      bool          setTemperatureCompensation(int ppmPerC, int referenceC, unsigned long refreshMillis);
+      int           getTemperatureCompensation();
+    #endif
+
+    // Battery State of Charge
+    bool          setBattery(byte battery);
+    bool          setBattery(const MCUVoltageBatteryPoint* curve, byte count);
+    byte          convertToPercent(unsigned long mV);
+    byte          convertReadingToPercent(unsigned long ADCReading, byte readingBitDepth);
+    byte          readPercent(byte avgTimes);
+
+    // Time Sliced Software Oversampled Readings
+    bool          beginOversample(byte targetBitDepth, byte avgTimes);
+    byte          step(unsigned int maxConversions);
+    byte          stepMicros(unsigned long maxMicros);
+
+    // Non-blocking Readings
+    bool          startReading();
+    bool          startReading(byte avgTimes);
+    bool          startReading_OS(byte targetBitDepth);
+    bool          startReading_OS(byte targetBitDepth, byte avgTimes);
+    bool          isReady();
+    bool          isBusy();
+    void          stopReading();
+    unsigned long getmV();
+    void          setCallback(MCUVoltageCallback myCallback);
+
+    // Vcc Thresholds
+    bool          watch(unsigned int lowmV, unsigned int highmV, MCUVoltageCallback myCallback);
+    void          stopWatching();
+    bool          isWatching();
+
+    // Background Sampling
+    bool          beginSampling();
+    void          stopSampling();
+    bool          isSampling();
+    byte          available();
+    byte          readSamples(unsigned int* buffer, byte maxSamples);
+    void          convertSamples(const unsigned int* samples, unsigned long* mV, byte count);
+    unsigned int  getDroppedSamples();
+    static unsigned long setSamplingRate(unsigned long rateHz);
+    static unsigned long getSamplingRate();
+
+    // Binary Streaming
+    byte          streamSamples(Print& output);
+
+    // ADC Sharing
+    bool          queueAnalogRead(byte pin, byte reference, unsigned int* reading);
+    bool          queueReading(unsigned long* mV, byte avgTimes);
+    byte          runQueue();
+    void          clearQueue();
+    byte          getQueueLength();
+    static void   saveADC();
+    static void   restoreADC();
+
+    // Instrumentation, only when MCUVOLTAGE_STATS is 1
+    #if MCUVOLTAGE_STATS
+      static MCUVoltageStats getStats();
+      static void            resetStats();
+    #endif
+
+    // Called by the ADC interrupt, not meant to be called by the user
+    static void   handleADCInterrupt();
     
-    // Exclusive to ATtiny3224/3226/3227
-    #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+    // Exclusive to ATtiny3224/3226/3227, tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+    #if MCUVOLTAGE_HWOS
     
       // Hardware Oversampled Readings
-      void          ADCSetup_HWOS(byte targetBitDepth);
-      unsigned int  readADC_HWOS();
+      bool          ADCSetup_HWOS(byte targetBitDepth);
+      unsigned long readADC_HWOS();
       unsigned long readmV_HWOS(byte targetBitDepth);
       unsigned long readmV_HWOS(byte targetBitDepth, byte avgTimes);
       float         read_HWOS(byte targetBitDepth);
       float         read_HWOS(byte targetBitDepth, byte avgTimes);
+      unsigned long readmV_HWOS_Adaptive(byte targetBitDepth, byte tolerancemV, byte maxAvgTimes);
+      bool          startReading_HWOS(byte targetBitDepth);
+      bool          startReading_HWOS(byte targetBitDepth, byte avgTimes);
+
+      // Called by the window compare interrupt, not meant to be called by the user
+      static void   handleWindowInterrupt();
 
       // Hardware Oversampled Getters and Setters
       byte          getBitDepth_HWOS();
@@ -135,14 +606,34 @@ class MCUVoltage
       
     #endif
 
+
+    // Exclusive to ATtiny3224/3226/3227
+    #if MCUVOLTAGE_ZOOM
+
+      // Zoomed Readings
+      bool          setZoom(unsigned long centremV, byte gain);
+      unsigned long readuV_Zoom(byte avgTimes);
+      unsigned long readmV_Zoom(byte avgTimes);
+
+      // Zoom Getters
+      bool          isInWindow_Zoom();
+      unsigned long getCentre_Zoom();
+      byte          getGain_Zoom();
+
+    #endif
+
     
     /*
      * Note on ADC readout return type:
      * readADC will be 10 or 12 bits, so unsigned int is ample.
      * However for oversampling, it can be higher, so we use unsigned long.
-     * For hardware oversampling, it will be max 16 bit so unsigned int is ample, but the resolution
-     * is 65536 and not 65535, thus unsigned long needed
+     * For hardware oversampling, the whole accumulated result is returned before decimating,
+     * up to 28 bits when bursts are added up past 17 bits, and the resolution can be 2^20,
+     * thus unsigned long needed
      */
 
 };
+
+#include "MCUVoltageT.h"
+
 #endif
@@ -0,0 +1,133 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Compile Time Specialised Header */
+
+/*
+ * MCUVoltageT<TargetBitDepth, AvgTimes, Bandgap> reads Vcc like
+ * readmV_OS(TargetBitDepth, AvgTimes) with a fixed bandgap, but every
+ * setting is known when compiling. The oversampled resolution, extra bits,
+ * sample count and bandgap*resolution are all constants, so there is no
+ * setup math when reading and an instance takes no SRAM.
+ *
+ * If TargetBitDepth is the native bit depth (10 or 12), no oversampling is done.
+ *
+ * The register level code is not in here but in the static setupRegisters() and
+ * convertOnce() of MCUVoltage, which this calls, so MCUVoltage is the core and
+ * this is the thin front end rather than the other way around. The bit depth,
+ * averaging and bandgap of MCUVoltage change while running and are kept per
+ * instance, and the non-blocking readings need the register code from the ADC
+ * interrupt, so they cannot be template parameters. What is folded in when
+ * compiling here is the math around the registers: the sample count, the
+ * decimation shift, the averaging and precompValue, which the conversion divides.
+ */
+
+
+#include "MCUVoltage.h"
+
+
+#ifndef MCUVOLTAGET_H
+#define MCUVOLTAGET_H
+
+template <byte TargetBitDepth, byte AvgTimes = 1, unsigned int Bandgap = MCUVOLTAGE_BANDGAP>
+class MCUVoltageT
+{
+  public:
+
+    // Oversampled bit depth, never below the native bit depth
+    static constexpr byte          bitDepth = TargetBitDepth > MCUVOLTAGE_BIT_DEPTH ? TargetBitDepth : MCUVOLTAGE_BIT_DEPTH;
+    static constexpr byte          extraBits = bitDepth - MCUVOLTAGE_BIT_DEPTH;
+    static constexpr unsigned long resolution = 1UL << bitDepth;
+    static constexpr unsigned int  sampleCount = 1U << (2*extraBits); // 4^extraBits
+    static constexpr byte          avgTimes = AvgTimes < 1 ? 1 : AvgTimes;
+    static constexpr unsigned int  bandgap = Bandgap;
+    static constexpr unsigned long precompValue = (unsigned long)Bandgap * resolution;
+
+    // Same limits as the tables for readmV_OS(byte targetBitDepth, byte avgTimes) in the readme
+    static_assert(extraBits <= 7, "MCUVoltageT: oversampling more than 7 extra bits overflows the sample count");
+    static_assert((unsigned long long)((1UL << MCUVOLTAGE_BIT_DEPTH) - 1) * sampleCount <= 0xFFFFFFFFULL,
+                  "MCUVoltageT: sum of samples overflows unsigned long");
+    static_assert((unsigned long long)(resolution - 1) * avgTimes <= 0xFFFFFFFFULL,
+                  "MCUVoltageT: sum of averages overflows unsigned long");
+    static_assert((unsigned long long)Bandgap * resolution <= 0xFFFFFFFFULL,
+                  "MCUVoltageT: bandgap*resolution overflows unsigned long");
+    static_assert(Bandgap > 0, "MCUVoltageT: bandgap cannot be zero");
+
+
+    // Read the ADC once, oversampled to bitDepth. Call ADCSetup() first.
+    static unsigned long readADC()
+    {
+      unsigned long sumOfSamples = 0;
+
+      for (unsigned int i=0; i<sampleCount; i++)
+      {
+        sumOfSamples += convertOnce();
+      }
+
+      return sumOfSamples >> extraBits; // Decimate
+    }
+
+
+    // Setup the ADC, throw away readings until the bandgap settles if the reference
+    // or mux was switched, then average avgTimes oversampled readings
+    static unsigned long readADCAveraged()
+    {
+      MCUVoltage::setupRegisters();
+
+      while (MCUVoltage::isSettling()) { MCUVoltage::discardSettling(convertOnce()); }
+
+      unsigned long sumOfAvg = 0;
+
+      for (byte i=0; i<avgTimes; i++)
+      {
+        sumOfAvg += readADC();
+      }
+
+      return sumOfAvg / avgTimes;
+    }
+
+
+    // Returns Vcc in millivolts, the same as convertToVcc() of MCUVoltage without fast conversion
+    static unsigned long readmV()
+    {
+      // Vcc = (Vbg*resolution)/ADCReading, with Vbg*resolution worked out by the compiler
+      return precompValue / readADCAveraged();
+    }
+
+
+    // Returns true if the ADC had to be set up, false if it already was
+    static bool ADCSetup()
+    {
+      return MCUVoltage::setupRegisters();
+    }
+
+  private:
+
+    // One conversion, counted when MCUVOLTAGE_STATS is 1
+    static unsigned long convertOnce()
+    {
+      #if MCUVOLTAGE_STATS
+
+        unsigned long start = micros();
+        unsigned long reading = MCUVoltage::convertOnce();
+
+        MCUVoltage::countConversion(extraBits > 0 ? SOFTWARE_OVERSAMPLING : REGULAR_READING, reading, micros() - start);
+
+        return reading;
+
+      #else
+
+        return MCUVoltage::convertOnce();
+
+      #endif
+    }
+
+};
+
+#endif
@@ -7,14 +7,15 @@
  *  https://github.com/cygig/MCUVoltage
 */
 
-/* ATtiny3224/3226/3227 Hardware Oversampling Methods */
+/* ATtiny3224/3226/3227, tinyAVR 0/1, megaAVR 0 and AVR Dx Hardware Oversampling Methods */
 
 
 #include "MCUVoltage.h"
 
 
-// Methods in this page will only be compiled if chip is ATtiny3224/3226/3227
-#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+// Methods in this page will only be compiled if the ADC can accumulate samples,
+// ATtiny3224/3226/3227, tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#if MCUVOLTAGE_HWOS
 
 
 /*================================================================================*/
@@ -22,76 +23,114 @@
 
 // Set up the ADC according to target bit depth
 // Since this is a must-call function before reading,
-// also precomputes and constrain the HWOS bit depth res and extra bits
-void MCUVoltage::ADCSetup_HWOS(byte targetBitDepth)
+// also precomputes and constrain the HWOS bit depth res and extra bits.
+// Returns true if the ADC had to be set up, false if it already was.
+bool MCUVoltage::ADCSetup_HWOS(byte targetBitDepth)
 {
+  // Temperature first, it needs the ADC too
+  refreshTemperature();
 
-  // Default to 16 bit if it does not lies between 13 and 17
-  // This part not working!!!
+  // Default to 16 bits (ATtiny3224/3226/3227) or the most (others) if out of range
   if (targetBitDepth < minBD_HWOS || targetBitDepth > maxBD_HWOS)
   {
     bitDepth_HWOS = defaultBD_HWOS;
   }
   else { bitDepth_HWOS = targetBitDepth; }
 
-  // Calculate and update the oversampled resolution
-  resolution_HWOS = intPow(2, bitDepth_HWOS);
+  // Calculate and update the oversampled resolution, 2^bitDepth_HWOS
+  resolution_HWOS = 1UL << bitDepth_HWOS;
 
   // Calculate extra bits oversampled
   extraBits_HWOS = bitDepth_HWOS - bitDepth;
 
-  // Most of the setup is the same
-  ADCSetup(); 
+  // One hardware accumulation for every reading, unless it needs more samples than the hardware takes
+  bursts_HWOS = 1;
+
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  byte myCTRLF, myCOMMAND;
   
   switch (bitDepth_HWOS)
   {
     case 13:
-      ADC0.CTRLF = 0b00000010; // Freerun and left adj disabled, accu 4^1=4 samples
+      myCTRLF = 0b00000010; // Freerun and left adj disabled, accu 4^1=4 samples
       break;
     case 14:
-      ADC0.CTRLF = 0b00000100; // Freerun and left adj disabled, accu 4^2=16 samples
+      myCTRLF = 0b00000100; // Freerun and left adj disabled, accu 4^2=16 samples
       break;   
     case 15:
-      ADC0.CTRLF = 0b00000110; // Freerun and left adj disabled, accu 4^3=64 samples
+      myCTRLF = 0b00000110; // Freerun and left adj disabled, accu 4^3=64 samples
       break;   
     case 16:
-      ADC0.CTRLF = 0b00001000; // Freerun and left adj disabled, accu 4^4=256 samples
+      myCTRLF = 0b00001000; // Freerun and left adj disabled, accu 4^4=256 samples
       break;
     case 17:
-      ADC0.CTRLF = 0b00001010; // Freerun and left adj disabled, accu 4^5=1024 samples
+      myCTRLF = 0b00001010; // Freerun and left adj disabled, accu 4^5=1024 samples
+      break;
+    case 18:
+    case 19:
+    case 20:
+      // 1024 is the most the hardware takes, 4^1=4, 4^2=16 or 4^3=64 bursts of it are added up
+      myCTRLF = 0b00001010; // Freerun and left adj disabled, accu 1024 samples
+      bursts_HWOS = 1 << ((bitDepth_HWOS - 17) * 2);
       break;
     default: // Should never go into this
-      ADC0.CTRLF = 0b00000000; // Freerun and left adj disabled, accu 4^0=1 sample
+      myCTRLF = 0b00000000; // Freerun and left adj disabled, accu 4^0=1 sample
       break;      
   }
 
   if (bitDepth_HWOS == defaultBD_HWOS)
   {
     // if 16 bits, set to singled ended reading, bursted scaling mode (scales to 16 bit)
-    ADC0.COMMAND = 0b01010000;
+    myCOMMAND = 0b01010000;
+    shift_HWOS = 0;
   }
   else
   {
-    // else we set singled ended reading, bursted mode, no scaling, read entire result
-    ADC0.COMMAND = 0b01000000; 
+    // else we set singled ended reading, bursted mode, no scaling, read entire result.
+    // 1024 samples of 12 bits are 22 bits, 64 bursts of them 28 bits, so the sum always fits 32 bits.
+    myCOMMAND = 0b01000000; 
+    shift_HWOS = extraBits_HWOS;
   }
 
+  // Most of the setup is the same as regular readings
+  return setupRegisters(myCTRLF, myCOMMAND);
+
+#else
+
+  // Accumulate 4^extraBits samples, SAMPNUM is the power of 2
+  byte mySAMPNUM = extraBits_HWOS * 2;
+
+  // RES only has 16 bits, the AVR Dx drops the bottom bits of a larger result by itself
+  byte accumulatedBits = bitDepth + mySAMPNUM;
+  byte dropped = accumulatedBits > 16 ? accumulatedBits - 16 : 0;
+
+  // Decimate what is left
+  shift_HWOS = extraBits_HWOS - dropped;
+
+  // Most of the setup is the same as regular readings
+  return setupRegisters(mySAMPNUM);
+
+#endif
 }
 
 
 /*================================================================================*/
 
 
-// Read the ADC value of bandgap voltage against Vcc with hardware oversampling
-unsigned int MCUVoltage::readADC_HWOS()
+// Read the ADC value of bandgap voltage against Vcc with hardware oversampling, not decimated.
+// Every burst is read whole, 32 bits on the ATtiny3224/3226/3227, and added up in 32 bits.
+unsigned long MCUVoltage::readADC_HWOS()
 {
-  ADC0.COMMAND |= 0b00000001; // Set singled ended reading, bursted scaling mode and start conversion
+  unsigned long sum = 0;
 
-  // When Bit 0 of STATUS is 1, ADC is converting, wait. Conversion done when it is 0.
-  while ( ADC0.STATUS > 0 ){}
+  // Start each burst and wait for it
+  for (byte i=0; i<bursts_HWOS; i++)
+  {
+    sum += convert();
+  }
 
-  // Read the whole 32 bits
-  lastADCReading = ADC0.RESULT;
+  lastADCReading = sum;
 
   return lastADCReading;
 }
@@ -101,7 +140,7 @@ unsigned int MCUVoltage::readADC_HWOS()
 
 
 // Read Vcc with hardware oversampling once only.
-// Recommend to use the averaging method as it throws away the first reading.
+// Recommend to use the averaging method as it throws away readings until the bandgap settles.
 unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth)
 {
   mode = HARDWARE_OVERSAMPLING;
@@ -112,12 +151,10 @@ unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth)
   // lastADCReading should be updated inside
   readADC_HWOS(); 
 
-  // If not 16 bits, decimate
-  // 16 bits result will be hardware scaled, so no need for that
-  // use bitDepth_HWOS instead of bitDepth_HWOS because its constrained
-  if (bitDepth_HWOS != defaultBD_HWOS ) { lastADCReading >>= extraBits_HWOS; }
+  // Decimate, 16 bits result on the ATtiny3224/3226/3227 will be hardware scaled, so no need for that
+  lastADCReading >>= shift_HWOS;
   
-  unsigned long result = convertToVcc(bandgap, resolution_HWOS, lastADCReading);
+  unsigned long result = convertToVcc(lastADCReading, bitDepth_HWOS);
 
   return result;
 }
@@ -127,7 +164,7 @@ unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth)
 
 
 // Read Vcc with hardware oversampling many times and average the readings. 
-// One reading is thrown away before averaging.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
 unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth, byte avgTimes)
 {
   mode = HARDWARE_OVERSAMPLING;
@@ -136,10 +173,9 @@ unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth, byte avgTimes)
   if (avgTimes <1){ avgTimes=1; }
   
   // Setup before reading ADC
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
   ADCSetup_HWOS(targetBitDepth);
-  
-  // Throw away first reading
-  readADC_HWOS();
+  settle();
 
   unsigned long sum=0;
   
@@ -147,9 +183,8 @@ unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth, byte avgTimes)
   {
     readADC_HWOS(); // lastADCReading updated inside
     
-    // If not 16 bits, decimate
-    // 16 bits result will be hardware scaled, so no need for that
-    if (bitDepth_HWOS != defaultBD_HWOS) { lastADCReading >>= extraBits_HWOS; }
+    // Decimate, 16 bits result on the ATtiny3224/3226/3227 will be hardware scaled, so no need for that
+    lastADCReading >>= shift_HWOS;
     
     sum += lastADCReading;
   }
@@ -157,7 +192,7 @@ unsigned long MCUVoltage::readmV_HWOS(byte targetBitDepth, byte avgTimes)
   // Store a copy of the last average reading
   lastADCReading = sum / avgTimes;
   
-  unsigned long result = convertToVcc(bandgap, resolution_HWOS, lastADCReading);
+  unsigned long result = convertToVcc(lastADCReading, bitDepth_HWOS);
 
   return result;
 }
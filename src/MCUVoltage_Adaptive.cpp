@@ -0,0 +1,166 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Adaptive Averaging Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Always average at least this many readings, fewer is not enough to tell the noise
+#define MIN_AVG_ADAPTIVE 4
+
+
+/*================================================================================*/
+
+
+// Average readings of the current mode until the mean is known to within tolerancemV,
+// or maxAvgTimes readings are done. ADC must be set up before this.
+unsigned long MCUVoltage::averageAdaptive(byte readingBitDepth, byte tolerancemV, byte maxAvgTimes)
+{
+  // Min averaging times is 1
+  if (maxAvgTimes <1){ maxAvgTimes=1; }
+
+  // Sum of readings for the average
+  unsigned long sumOfReadings = 0;
+
+  // The spread is worked out in millivolts from the first reading,
+  // so the numbers stay small and fit in unsigned long
+  long          firstmV = 0;
+  long          sumOfDiff = 0;
+  unsigned long sumOfSquares = 0;
+
+  // At most 255^2*255^2, still fits in unsigned long
+  unsigned long toleranceSquared = (unsigned long)tolerancemV * tolerancemV;
+
+  byte count = 0;
+
+  while (count < maxAvgTimes)
+  {
+    unsigned long reading;
+
+    switch (mode)
+    {
+      case SOFTWARE_OVERSAMPLING:
+        reading = readADC_OS();
+        break;
+
+      #if MCUVOLTAGE_HWOS
+      case HARDWARE_OVERSAMPLING:
+        reading = readADC_HWOS();
+
+        // Decimate, 16 bits result on the ATtiny3224/3226/3227 will be hardware scaled, so no need for that
+        reading >>= shift_HWOS;
+        break;
+      #endif
+
+      default:
+        reading = readADC();
+        break;
+    }
+
+    sumOfReadings += reading;
+    count++;
+
+    long diff = (long)convertToVcc(reading, readingBitDepth);
+    if (count == 1) { firstmV = diff; }
+    diff -= firstmV;
+
+    sumOfDiff += diff;
+    sumOfSquares += diff * diff;
+
+    if (count >= MIN_AVG_ADAPTIVE)
+    {
+      // Sum of squared differences from the mean, this is variance*count.
+      // sumOfDiff^2/count is never more than sumOfSquares, and written this way it cannot overflow
+      unsigned long spread = sumOfSquares - (unsigned long)((sumOfDiff / count) * sumOfDiff);
+
+      // The 95% confidence interval of the mean is about +/- 2*sqrt(variance/count),
+      // which is 2*sqrt(spread)/count. Squaring both sides, it is within tolerance when:
+      if (4 * spread <= (unsigned long)count * count * toleranceSquared) { break; }
+    }
+  }
+
+  avgTimes_Adaptive = count;
+
+  // Store a copy of the average reading
+  lastADCReading = sumOfReadings / count;
+
+  return convertToVcc(lastADCReading, readingBitDepth);
+}
+
+
+/*================================================================================*/
+
+
+// Read Vcc many times and average the readings, stopping early if the readings are steady.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+unsigned long MCUVoltage::readmV_Adaptive(byte tolerancemV, byte maxAvgTimes)
+{
+  mode = REGULAR_READING;
+
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+  ADCSetup();
+  settle();
+
+  return averageAdaptive(bitDepth, tolerancemV, maxAvgTimes);
+}
+
+
+/*================================================================================*/
+
+
+// Read Vcc with software oversampling many times and average the readings,
+// stopping early if the readings are steady.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+unsigned long MCUVoltage::readmV_OS_Adaptive(byte targetBitDepth, byte tolerancemV, byte maxAvgTimes)
+{
+  mode = SOFTWARE_OVERSAMPLING;
+
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+  ADCSetup_OS(targetBitDepth);
+  settle();
+
+  return averageAdaptive(bitDepth_OS, tolerancemV, maxAvgTimes);
+}
+
+
+/*================================================================================*/
+
+
+#if MCUVOLTAGE_HWOS
+
+  // Read Vcc with hardware oversampling many times and average the readings,
+  // stopping early if the readings are steady.
+  // Readings are thrown away until the bandgap settles if the reference or mux was switched.
+  unsigned long MCUVoltage::readmV_HWOS_Adaptive(byte targetBitDepth, byte tolerancemV, byte maxAvgTimes)
+  {
+    mode = HARDWARE_OVERSAMPLING;
+
+    // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+    ADCSetup_HWOS(targetBitDepth);
+    settle();
+
+    return averageAdaptive(bitDepth_HWOS, tolerancemV, maxAvgTimes);
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Number of readings averaged by the last adaptive reading
+byte MCUVoltage::getAvgTimes_Adaptive()
+{
+  return avgTimes_Adaptive;
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,351 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Non-blocking (Interrupt Driven) Methods */
+
+
+#include "MCUVoltage.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+
+// True while the CPU sleeps through a blocking conversion
+volatile bool MCUVoltage::asleep = false;
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  void MCUVoltage::startConversion()
+  {
+    ADC0.COMMAND |= 0b00000001; // Start conversion
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  void MCUVoltage::startConversion()
+  {
+    ADC0.COMMAND = 0b00000001; // Start conversion (STCONV)
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+#else
+
+  void MCUVoltage::startConversion()
+  {
+    ADCSRA |= 0b01000000; // Start the conversion
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Runs inside the ISR after every conversion
+void MCUVoltage::processConversion()
+{
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+    // Reading RESULT also clears the result ready flag
+    unsigned long reading = ADC0.RESULT;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    // Reading RES also clears the result ready flag
+    unsigned long reading = ADC0.RES;
+
+  #else
+
+    unsigned long reading = ADCL; // Must read ADCL first
+    reading |= ADCH<<8; // Shift 8 bits to the left and add on to value
+
+    // Timer1 compare match B only starts the next conversion once its flag is cleared
+    if (sampling && samplingRate != 0) { TIFR1 = 0b00000100; }
+
+  #endif
+
+  // Nothing waited on this one
+  #if MCUVOLTAGE_STATS
+    countConversion(mode, reading, 0);
+  #endif
+
+  #if !defined(__AVR_ATtiny3224__) && !defined(__AVR_ATtiny3226__) && !defined(__AVR_ATtiny3227__) && !MCUVOLTAGE_SAMPNUM_ADC
+
+    // Watching only compares, every ADC but the ATmega one does this by itself
+    if (watching)
+    {
+      if (reading < lowThreshold_Watch || reading > highThreshold_Watch) { windowLeft(reading); }
+      return;
+    }
+
+  #endif
+
+  // Throw away the readings taken while the bandgap settles
+  if (settleFirst_Async && settling)
+  {
+    discardSettling(reading);
+
+    // Free running ADC starts the next conversion by itself
+    if (!sampling) { startConversion(); }
+    return;
+  }
+
+  // Background sampler only keeps the raw readings
+  if (sampling)
+  {
+    pushSample(reading);
+    return;
+  }
+
+  // Still need more readings
+  if (!accumulateReading(reading))
+  {
+    startConversion();
+    return;
+  }
+
+  // All done, free up the ADC
+  disableADCInterrupt();
+  activeInstance = NULL;
+  busy = false;
+  ready = true;
+
+  if (callback != NULL) { callback(convertLastReading()); }
+}
+
+
+/*================================================================================*/
+
+
+// Common part of starting any non-blocking reading, ADC must be set up before this
+bool MCUVoltage::beginAsync(bool settleFirst, byte avgTimes)
+{
+  resetAccumulator(settleFirst, avgTimes);
+  ready = false;
+  busy = true;
+
+  enableADCInterrupt();
+  startConversion();
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Start reading Vcc once only without waiting for the ADC.
+// Recommend to use the averaging method as it throws away readings until the bandgap settles.
+bool MCUVoltage::startReading()
+{
+  // ADC is being used by another reading
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = REGULAR_READING;
+  ADCSetup();
+
+  return beginAsync(false, 1);
+}
+
+
+/*================================================================================*/
+
+
+// Start reading Vcc many times without waiting for the ADC.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+bool MCUVoltage::startReading(byte avgTimes)
+{
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = REGULAR_READING;
+
+  ADCSetup();
+
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+  return beginAsync(true, avgTimes);
+}
+
+
+/*================================================================================*/
+
+
+// Start reading Vcc with software oversampling once only without waiting for the ADC.
+bool MCUVoltage::startReading_OS(byte targetBitDepth)
+{
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = SOFTWARE_OVERSAMPLING;
+  ADCSetup_OS(targetBitDepth);
+
+  return beginAsync(false, 1);
+}
+
+
+/*================================================================================*/
+
+
+// Start reading Vcc with software oversampling many times without waiting for the ADC.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+bool MCUVoltage::startReading_OS(byte targetBitDepth, byte avgTimes)
+{
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = SOFTWARE_OVERSAMPLING;
+
+  ADCSetup_OS(targetBitDepth);
+  
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+  return beginAsync(true, avgTimes);
+}
+
+
+/*================================================================================*/
+
+
+#if MCUVOLTAGE_HWOS
+
+  // Start reading Vcc with hardware oversampling once only without waiting for the ADC.
+  bool MCUVoltage::startReading_HWOS(byte targetBitDepth)
+  {
+    if (activeInstance != NULL) { return false; }
+    activeInstance = this;
+
+    mode = HARDWARE_OVERSAMPLING;
+    ADCSetup_HWOS(targetBitDepth);
+
+    return beginAsync(false, 1);
+  }
+
+
+  // Start reading Vcc with hardware oversampling many times without waiting for the ADC.
+  // Readings are thrown away until the bandgap settles if the reference or mux was switched.
+  bool MCUVoltage::startReading_HWOS(byte targetBitDepth, byte avgTimes)
+  {
+    if (activeInstance != NULL) { return false; }
+    activeInstance = this;
+
+    mode = HARDWARE_OVERSAMPLING;
+
+    ADCSetup_HWOS(targetBitDepth);
+    
+    // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
+    return beginAsync(true, avgTimes);
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Start a conversion and sleep until it is done, then return the result.
+// Less digital noise from the CPU gets into the reading this way.
+unsigned long MCUVoltage::convertSleeping()
+{
+  // Keep the interrupt setting of the caller, but interrupts are needed to wake up
+  byte oldSREG = SREG;
+  asleep = true;
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+
+    // ADC keeps running in idle, timers (and millis()) keep running too
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+  #else
+
+    // Only the ADC and a few asynchronous modules keep running
+    // Timer 0 stops, so millis() does not count while converting
+    set_sleep_mode(SLEEP_MODE_ADC);
+
+  #endif
+
+  enableADCInterrupt();
+  startConversion();
+  sleep_enable();
+
+  while (true)
+  {
+    cli();
+
+    #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+      bool converting = ADC0.STATUS > 0; // Bit 0 of STATUS is 1 while converting
+    #elif MCUVOLTAGE_SAMPNUM_ADC
+      bool converting = ADC0.COMMAND & 0b00000001; // Bit 0 (STCONV) is 1 while converting
+    #else
+      bool converting = (ADCSRA & 0b01000000) > 0; // Bit 6 (ADSC) is 1 while converting
+    #endif
+
+    if (!converting) { break; }
+
+    // The instruction after sei() always runs before any interrupt,
+    // so the ADC interrupt cannot slip in between and leave us asleep
+    sei();
+    sleep_cpu();
+
+    // Woken up by the ADC or any other interrupt, check again
+  }
+
+  sleep_disable();
+  disableADCInterrupt();
+  asleep = false;
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+    // Read the whole 32 bits, accumulated results can be more than 16 bits
+    unsigned long reading = ADC0.RESULT;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    // 16 bits, accumulated results included
+    unsigned long reading = ADC0.RES;
+
+  #else
+
+    unsigned long reading = ADCL; // Must read ADCL first
+    reading |= ADCH<<8; // Shift 8 bits to the left and add on to value
+
+  #endif
+
+  SREG = oldSREG;
+
+  return reading;
+}
+
+
+/*================================================================================*/
+
+
+// Put the CPU to sleep during every blocking conversion of this instance
+void MCUVoltage::setNoiseReduction(bool enable)
+{
+  sleepConversion = convertSleeping;
+  noiseReduction = enable;
+}
+
+
+/*================================================================================*/
+
+
+bool MCUVoltage::getNoiseReduction()
+{
+  return noiseReduction;
+}
+
+
+/*================================================================================*/
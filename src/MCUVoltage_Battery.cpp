@@ -0,0 +1,157 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Battery State of Charge Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Discharge curves as Vcc in millivolts against percent, lowest Vcc first.
+// Resting voltage at light load, for the battery powering Vcc directly.
+
+// One Li-ion or LiPo cell, 3.0V to 4.2V
+static const MCUVoltageBatteryPoint curveLiIon[] PROGMEM =
+{
+  {3000, 0}, {3270, 1}, {3610, 5}, {3690, 10}, {3710, 15}, {3730, 20}, {3750, 25},
+  {3770, 30}, {3790, 35}, {3800, 40}, {3820, 45}, {3840, 50}, {3850, 55}, {3870, 60},
+  {3910, 65}, {3950, 70}, {3980, 75}, {4020, 80}, {4080, 85}, {4110, 90}, {4150, 95},
+  {4200, 100}
+};
+
+// Two alkaline AA or AAA cells in series, 1.8V to 3.2V
+static const MCUVoltageBatteryPoint curveAlkaline2[] PROGMEM =
+{
+  {1800, 0}, {2000, 5}, {2200, 10}, {2300, 20}, {2400, 30}, {2500, 40}, {2600, 50},
+  {2700, 60}, {2800, 70}, {2900, 80}, {3000, 90}, {3200, 100}
+};
+
+// Three NiMH AA or AAA cells in series, 3.0V to 4.2V
+static const MCUVoltageBatteryPoint curveNiMH3[] PROGMEM =
+{
+  {3000, 0}, {3300, 5}, {3390, 10}, {3480, 20}, {3540, 30}, {3600, 40}, {3660, 50},
+  {3720, 60}, {3780, 70}, {3840, 80}, {3900, 90}, {4200, 100}
+};
+
+// One CR2032 or similar lithium coin cell, 2.0V to 3.0V
+static const MCUVoltageBatteryPoint curveCoin[] PROGMEM =
+{
+  {2000, 0}, {2200, 5}, {2400, 10}, {2500, 20}, {2600, 30}, {2700, 40}, {2750, 50},
+  {2800, 60}, {2850, 70}, {2900, 80}, {2950, 90}, {3000, 100}
+};
+
+
+/*================================================================================*/
+
+
+// Use one of the built in discharge curves. Returns false if battery is not known.
+bool MCUVoltage::setBattery(byte battery)
+{
+  switch (battery)
+  {
+    case BATTERY_LIION:
+      return setBattery(curveLiIon, sizeof(curveLiIon)/sizeof(curveLiIon[0]));
+
+    case BATTERY_ALKALINE_2:
+      return setBattery(curveAlkaline2, sizeof(curveAlkaline2)/sizeof(curveAlkaline2[0]));
+
+    case BATTERY_NIMH_3:
+      return setBattery(curveNiMH3, sizeof(curveNiMH3)/sizeof(curveNiMH3[0]));
+
+    case BATTERY_COIN:
+      return setBattery(curveCoin, sizeof(curveCoin)/sizeof(curveCoin[0]));
+
+    default:
+      return false;
+  }
+}
+
+
+/*================================================================================*/
+
+
+// Use a discharge curve of your own, in PROGMEM, lowest Vcc first.
+// Returns false if there are fewer than 2 points.
+bool MCUVoltage::setBattery(const MCUVoltageBatteryPoint* curve, byte count)
+{
+  if (curve == NULL || count < 2) { return false; }
+
+  curve_Battery = curve;
+  count_Battery = count;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Percent of charge left at Vcc of mV, 0 if no curve is set.
+// Binary search for the two points around mV, then a straight line between them.
+byte MCUVoltage::convertToPercent(unsigned long mV)
+{
+  if (curve_Battery == NULL) { return 0; }
+
+  // Below the first or above the last point
+  if (mV <= pgm_read_word(&curve_Battery[0].mV)) { return pgm_read_byte(&curve_Battery[0].percent); }
+
+  byte last = count_Battery - 1;
+  if (mV >= pgm_read_word(&curve_Battery[last].mV)) { return pgm_read_byte(&curve_Battery[last].percent); }
+
+  // Point low is at or below mV, point high is above
+  byte low = 0, high = last;
+
+  while (high - low > 1)
+  {
+    byte middle = (low + high) >> 1;
+
+    if (pgm_read_word(&curve_Battery[middle].mV) <= mV) { low = middle; }
+    else { high = middle; }
+  }
+
+  unsigned int mV0 = pgm_read_word(&curve_Battery[low].mV);
+  unsigned int mV1 = pgm_read_word(&curve_Battery[high].mV);
+  byte percent0 = pgm_read_byte(&curve_Battery[low].percent);
+  byte percent1 = pgm_read_byte(&curve_Battery[high].percent);
+
+  // Curves may go down as well as up
+  unsigned int span = mV1 - mV0;
+  unsigned int offset = mV - mV0;
+  byte change = percent1 >= percent0 ? percent1 - percent0 : percent0 - percent1;
+
+  // Rounded. A 16 bit divide takes a fraction of the time of a 32 bit one on the AVR. Every
+  // built in curve fits in 16 bits, only a long segment of a curve of your own may not.
+  unsigned long product = (unsigned long)change * offset + span/2;
+  byte step = product <= 0xFFFF ? (unsigned int)product / span : product / span;
+
+  return percent1 >= percent0 ? percent0 + step : percent0 - step;
+}
+
+
+/*================================================================================*/
+
+
+// Percent of charge left from a raw ADC reading of any bit depth, e.g. from readSamples()
+byte MCUVoltage::convertReadingToPercent(unsigned long ADCReading, byte readingBitDepth)
+{
+  return convertToPercent(convertToVcc(ADCReading, readingBitDepth));
+}
+
+
+/*================================================================================*/
+
+
+// Read Vcc averaged avgTimes times like readmV(byte avgTimes), as percent of charge left
+byte MCUVoltage::readPercent(byte avgTimes)
+{
+  return convertToPercent(readmV(avgTimes));
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,263 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Calibration Methods */
+
+
+#include "MCUVoltage.h"
+#include <avr/eeprom.h>
+
+
+// Changes whenever the layout saved by saveCalibration() changes, so an old one is not loaded
+#define CALIBRATION_VERSION 1
+
+// Largest millivolts calibrate() takes, so the math fits in a long
+#define CALIBRATION_MAX_MV 32767
+
+
+/*================================================================================*/
+
+
+// CRC-8 (polynomial 0x07), so a half written or foreign record is not loaded.
+// Also checks the frames of streamSamples().
+byte MCUVoltage::crc8(const byte* data, byte length)
+{
+  byte crc = 0;
+
+  for (byte i=0; i<length; i++)
+  {
+    crc ^= data[i];
+
+    for (byte bit=0; bit<8; bit++)
+    {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+
+  return crc;
+}
+
+
+// n/d rounded to the nearest, d must be more than 0
+static long divideRounded(long n, long d)
+{
+  if (n >= 0) { return (n + d/2) / d; }
+  return -((-n + d/2) / d);
+}
+
+
+/*================================================================================*/
+
+
+// Set the bandgap (with fraction bits) and offset used to convert readings,
+// and precompute everything that depends on them
+void MCUVoltage::setCalibration(unsigned int myBandgap, int myOffset)
+{
+  bandgap_Calibration = myBandgap;
+  offset_Calibration = myOffset;
+
+  compensate();
+}
+
+
+/*================================================================================*/
+
+
+// Move the calibrated bandgap by the temperature coefficient, away from the reference temperature,
+// so it is only worked out when the temperature or calibration changes, never per reading
+void MCUVoltage::compensate()
+{
+  long myBandgap = bandgap_Calibration;
+
+  if (tempco_Temperature != 0 && temperatureKnown)
+  {
+    // Parts per million the bandgap is off by, at most 3% so bandgap*ppm fits in a long
+    long ppm = (long)tempco_Temperature * (temperature - reference_Temperature);
+    if (ppm > 30000L) { ppm = 30000L; }
+    if (ppm < -30000L) { ppm = -30000L; }
+
+    myBandgap += divideRounded(myBandgap * ppm, 1000000L);
+    if (myBandgap < 1) { myBandgap = 1; }
+    if (myBandgap > 0xFFFF) { myBandgap = 0xFFFF; }
+
+    used_Temperature = temperature;
+  }
+
+  bandgap_Compensated = myBandgap;
+
+  // MUST cast to unsigned long.
+  precompValue = (unsigned long)bandgap_Compensated << (bitDepth - fractionBits_Calibration);
+}
+
+
+/*================================================================================*/
+
+
+// Add the calibrated offset to Vcc, a Vcc of 0 (no reading) stays 0 and never goes below 0
+unsigned long MCUVoltage::addOffset(unsigned long mV)
+{
+  if (offset_Calibration == 0 || mV == 0) { return mV; }
+
+  long result = (long)mV + offset_Calibration;
+  return result > 0 ? result : 0;
+}
+
+
+/*================================================================================*/
+
+
+// Vcc in millivolts back to the reading of readingBitDepth bits that gives it.
+// Without the offset, Vcc = bandgap*2^readingBitDepth/reading works both ways.
+unsigned long MCUVoltage::convertToReading(unsigned long mV, byte readingBitDepth)
+{
+  long uncalibrated = (long)mV - offset_Calibration;
+  if (uncalibrated < 1) { uncalibrated = 1; }
+
+  return reciprocalVcc(bandgap_Compensated, readingBitDepth - fractionBits_Calibration, uncalibrated);
+}
+
+
+/*================================================================================*/
+
+
+// One point calibration, a gain only. measuredmV is Vcc as read now, e.g. by readmV(byte avgTimes),
+// and actualmV what a multimeter shows at the same time. Applies on top of any calibration in use.
+// Returns false, and nothing changes, if the values are 0, too large, or give a bandgap out of range.
+bool MCUVoltage::calibrate(unsigned long measuredmV, unsigned long actualmV)
+{
+  if (measuredmV == 0 || actualmV == 0) { return false; }
+  if (measuredmV > CALIBRATION_MAX_MV || actualmV > CALIBRATION_MAX_MV) { return false; }
+
+  // Gain = actual/measured, both the bandgap and the offset scale with it
+  unsigned long newBandgap = ((unsigned long)bandgap_Calibration * actualmV + measuredmV/2) / measuredmV;
+  long newOffset = divideRounded((long)offset_Calibration * (long)actualmV, measuredmV);
+
+  if (newBandgap == 0 || newBandgap > 0xFFFF) { return false; }
+  if (newOffset < -32768L || newOffset > 32767L) { return false; }
+
+  setCalibration(newBandgap, newOffset);
+  calibrated = true;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Two point calibration, a gain and an offset, from Vcc read (measuredmV) and Vcc on a multimeter
+// (actualmV) at two different supply voltages, the further apart the better. Applies on top of any
+// calibration in use, call clearCalibration() before reading measuredmV1 and 2 to start over.
+// Returns false, and nothing changes, if the points are the same, cross over, or are out of range.
+bool MCUVoltage::calibrate(unsigned long measuredmV1, unsigned long actualmV1, unsigned long measuredmV2, unsigned long actualmV2)
+{
+  if (measuredmV1 > CALIBRATION_MAX_MV || actualmV1 > CALIBRATION_MAX_MV) { return false; }
+  if (measuredmV2 > CALIBRATION_MAX_MV || actualmV2 > CALIBRATION_MAX_MV) { return false; }
+
+  // Gain = (actual2 - actual1)/(measured2 - measured1), must be more than 0
+  long num = (long)actualmV2 - (long)actualmV1;
+  long den = (long)measuredmV2 - (long)measuredmV1;
+
+  if (den < 0) { num = -num; den = -den; }
+  if (den == 0 || num <= 0) { return false; }
+
+  // actual = gain*(Vcc + offset) + actual1 - gain*measured1, where Vcc follows the bandgap,
+  // so the bandgap scales by the gain and the offset becomes gain*(offset - measured1) + actual1
+  unsigned long newBandgap = ((unsigned long)bandgap_Calibration * num + den/2) / den;
+  long newOffset = divideRounded(((long)offset_Calibration - (long)measuredmV1) * num, den) + (long)actualmV1;
+
+  if (newBandgap == 0 || newBandgap > 0xFFFF) { return false; }
+  if (newOffset < -32768L || newOffset > 32767L) { return false; }
+
+  setCalibration(newBandgap, newOffset);
+  calibrated = true;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Back to the bandgap set by the constructor or setBandgap(unsigned int myBandgap), and no offset
+void MCUVoltage::clearCalibration()
+{
+  setCalibration(bandgap << fractionBits_Calibration, 0);
+  calibrated = false;
+}
+
+
+/*================================================================================*/
+
+
+// True once calibrate() or loadCalibration() has succeeded, until clearCalibration() or setBandgap()
+bool MCUVoltage::isCalibrated()
+{
+  return calibrated;
+}
+
+
+/*================================================================================*/
+
+
+// Millivolts added to every Vcc by a two point calibration
+int MCUVoltage::getOffset_Calibration()
+{
+  return offset_Calibration;
+}
+
+
+/*================================================================================*/
+
+
+// Keep the calibration in the EEPROM at MCUVOLTAGE_CALIBRATION_ADDRESS, with a version and a CRC.
+// Only bytes that changed are written, so saving the same calibration again does not wear the EEPROM.
+void MCUVoltage::saveCalibration()
+{
+  byte record[MCUVOLTAGE_CALIBRATION_SIZE];
+
+  record[0] = CALIBRATION_VERSION;
+  record[1] = bandgap_Calibration;
+  record[2] = bandgap_Calibration >> 8;
+  record[3] = offset_Calibration;
+  record[4] = (unsigned int)offset_Calibration >> 8;
+  record[5] = crc8(record, MCUVOLTAGE_CALIBRATION_SIZE - 1);
+
+  eeprom_update_block(record, (void*)MCUVOLTAGE_CALIBRATION_ADDRESS, MCUVOLTAGE_CALIBRATION_SIZE);
+}
+
+
+/*================================================================================*/
+
+
+// Use the calibration kept by saveCalibration(), done by the constructor without a bandgap.
+// Returns false, and nothing changes, if there is none or it fails the version or CRC check.
+bool MCUVoltage::loadCalibration()
+{
+  byte record[MCUVOLTAGE_CALIBRATION_SIZE];
+
+  eeprom_read_block(record, (const void*)MCUVOLTAGE_CALIBRATION_ADDRESS, MCUVOLTAGE_CALIBRATION_SIZE);
+
+  // An erased EEPROM reads 0xFF, which fails the version
+  if (record[0] != CALIBRATION_VERSION) { return false; }
+  if (record[5] != crc8(record, MCUVOLTAGE_CALIBRATION_SIZE - 1)) { return false; }
+
+  unsigned int myBandgap = record[1] | ((unsigned int)record[2] << 8);
+  int myOffset = (int16_t)(record[3] | ((unsigned int)record[4] << 8));
+
+  if (myBandgap == 0) { return false; }
+
+  setCalibration(myBandgap, myOffset);
+  calibrated = true;
+
+  return true;
+}
+
+
+/*================================================================================*/
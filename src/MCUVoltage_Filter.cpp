@@ -0,0 +1,224 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Streaming Filter Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Sorting networks for 3, 5 and 7 values, as pairs of positions to compare and swap.
+// Same compares whatever the values, so the time taken is always the same.
+static const byte sortNetwork3[] PROGMEM = { 0,2, 0,1, 1,2 };
+static const byte sortNetwork5[] PROGMEM = { 0,1, 3,4, 2,4, 2,3, 0,3, 0,2, 1,4, 1,3, 1,2 };
+static const byte sortNetwork7[] PROGMEM = { 0,6, 2,3, 4,5, 0,2, 1,4, 3,6, 0,1, 2,5,
+                                             3,4, 1,2, 4,6, 2,3, 4,5, 1,2, 3,4, 5,6 };
+
+
+/*================================================================================*/
+
+
+// Sort size (3, 5 or 7) values in place, smallest first
+static void sortValues(unsigned int* values, byte size)
+{
+  const byte* network;
+  byte        compares;
+
+  switch (size)
+  {
+    case 3:  network = sortNetwork3; compares = sizeof(sortNetwork3)/2; break;
+    case 5:  network = sortNetwork5; compares = sizeof(sortNetwork5)/2; break;
+    default: network = sortNetwork7; compares = sizeof(sortNetwork7)/2; break;
+  }
+
+  for (byte i=0; i<compares; i++)
+  {
+    byte a = pgm_read_byte(&network[2*i]);
+    byte b = pgm_read_byte(&network[2*i + 1]);
+
+    if (values[a] > values[b])
+    {
+      unsigned int swap = values[a];
+      values[a] = values[b];
+      values[b] = swap;
+    }
+  }
+}
+
+
+/*================================================================================*/
+
+
+// Choose the filter used by readmV_Filtered() and filtermV(), and start it over.
+// FILTER_EMA takes the shift (1 to 8) as strength, alpha is 1/2^strength.
+// FILTER_MEDIAN, FILTER_TRIMMED and FILTER_HAMPEL take the window size (3, 5 or 7).
+// Returns false if the filter or strength is not known.
+bool MCUVoltage::setFilter(byte filter, byte strength)
+{
+  switch (filter)
+  {
+    case FILTER_NONE:
+      break;
+
+    case FILTER_EMA:
+      if (strength < 1 || strength > 8) { return false; }
+      break;
+
+    case FILTER_MEDIAN:
+    case FILTER_TRIMMED:
+    case FILTER_HAMPEL:
+      if (strength != 3 && strength != 5 && strength != 7) { return false; }
+      if (strength > MCUVOLTAGE_FILTER_SIZE) { return false; }
+      break;
+
+    default:
+      return false;
+  }
+
+  filter_Filter = filter;
+  strength_Filter = strength;
+  resetFilter();
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Forget every reading, the next one starts the filter over
+void MCUVoltage::resetFilter()
+{
+  started_Filter = false;
+}
+
+
+/*================================================================================*/
+
+
+byte MCUVoltage::getFilter()
+{
+  return filter_Filter;
+}
+
+
+/*================================================================================*/
+
+
+byte MCUVoltage::getStrength_Filter()
+{
+  return strength_Filter;
+}
+
+
+/*================================================================================*/
+
+
+// Read Vcc with one conversion, passed through the filter.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+unsigned long MCUVoltage::readmV_Filtered()
+{
+  mode = REGULAR_READING;
+
+  ADCSetup();
+  settle();
+
+  return filtermV(readADC());
+}
+
+
+/*================================================================================*/
+
+
+// Pass one raw reading in the native bit depth through the filter, e.g. from readSamples().
+// Returns the filtered Vcc in millivolts, lastADCReading is set to the filtered reading.
+unsigned long MCUVoltage::filtermV(unsigned int ADCReading)
+{
+  // First reading fills the whole filter, so it starts from there rather than from 0
+  if (!started_Filter)
+  {
+    sum_Filter = (unsigned long)ADCReading << strength_Filter;
+
+    for (byte i=0; i<MCUVOLTAGE_FILTER_SIZE; i++) { window_Filter[i] = ADCReading; }
+
+    index_Filter = 0;
+    started_Filter = true;
+  }
+
+  switch (filter_Filter)
+  {
+    case FILTER_EMA:
+    {
+      // sum_Filter is the average times 2^strength, so no fraction is lost:
+      // average += (reading - average) / 2^strength
+      sum_Filter -= sum_Filter >> strength_Filter;
+      sum_Filter += ADCReading;
+
+      lastADCReading = (sum_Filter + (1UL << (strength_Filter - 1))) >> strength_Filter;
+
+      // The fraction is kept for the conversion, as if read with strength more bits
+      return convertToVcc(sum_Filter, bitDepth + strength_Filter);
+    }
+
+    case FILTER_MEDIAN:
+    case FILTER_TRIMMED:
+    case FILTER_HAMPEL:
+    {
+      window_Filter[index_Filter] = ADCReading;
+      if (++index_Filter >= strength_Filter) { index_Filter = 0; }
+
+      unsigned int sorted[MCUVOLTAGE_FILTER_SIZE];
+      for (byte i=0; i<strength_Filter; i++) { sorted[i] = window_Filter[i]; }
+      sortValues(sorted, strength_Filter);
+
+      unsigned int median = sorted[strength_Filter/2];
+
+      if (filter_Filter == FILTER_MEDIAN)
+      {
+        lastADCReading = median;
+      }
+
+      // Leave out the lowest and highest, average the rest
+      else if (filter_Filter == FILTER_TRIMMED)
+      {
+        unsigned int sum = 0;
+        for (byte i=1; i<strength_Filter-1; i++) { sum += sorted[i]; }
+
+        byte kept = strength_Filter - 2;
+        lastADCReading = (sum + kept/2) / kept;
+      }
+
+      // Keep the reading unless it is too far from the median, judged by the
+      // median absolute deviation (MAD) of the window
+      else
+      {
+        for (byte i=0; i<strength_Filter; i++)
+        {
+          sorted[i] = window_Filter[i] > median ? window_Filter[i] - median : median - window_Filter[i];
+        }
+        sortValues(sorted, strength_Filter);
+
+        // 3 standard deviations is about 4.5 MAD, plus 1 step so quantisation alone is not an outlier
+        unsigned int limit = sorted[strength_Filter/2] * 9 / 2 + 1;
+        unsigned int deviation = ADCReading > median ? ADCReading - median : median - ADCReading;
+
+        lastADCReading = deviation > limit ? median : ADCReading;
+      }
+
+      return convertToVcc(lastADCReading);
+    }
+
+    default:
+      lastADCReading = ADCReading;
+      return convertToVcc(lastADCReading);
+  }
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,110 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* ADC Interrupt */
+
+/*
+ * The ADC interrupt is kept apart from the rest of the library. With dot_a_linkage
+ * in library.properties, the library is linked as an archive and a file is only
+ * linked in when the sketch uses something in it. Everything that needs the
+ * interrupt turns it on with enableADCInterrupt(), which is in here, so only
+ * sketches using the non-blocking readings, background sampling, noise reduction
+ * or watch() on the ATmega claim the ADC vector. Other sketches, and other
+ * libraries, are free to use it.
+ */
+
+
+#include "MCUVoltage.h"
+#include <avr/interrupt.h>
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // Result ready interrupt
+  ISR(ADC0_RESRDY_vect)
+  {
+    MCUVoltage::handleADCInterrupt();
+  }
+
+  void MCUVoltage::enableADCInterrupt()
+  {
+    // Clear any old result ready flag first, else the ISR fires immediately
+    ADC0.INTFLAGS = 0b00000001;
+
+    // Enable RESRDY interrupt
+    ADC0.INTCTRL |= 0b00000001;
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // Result ready interrupt
+  ISR(ADC0_RESRDY_vect)
+  {
+    MCUVoltage::handleADCInterrupt();
+  }
+
+  void MCUVoltage::enableADCInterrupt()
+  {
+    // Clear any old result ready flag first, else the ISR fires immediately
+    ADC0.INTFLAGS = 0b00000001;
+
+    // Enable RESRDY interrupt
+    ADC0.INTCTRL |= 0b00000001;
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+#else
+
+  // ADC conversion complete interrupt
+  ISR(ADC_vect)
+  {
+    MCUVoltage::handleADCInterrupt();
+  }
+
+  void MCUVoltage::enableADCInterrupt()
+  {
+    // Writing 1 to ADIF (Bit 4) clears it, else the ISR fires immediately
+    // ADIEN (Bit 3) enables the interrupt
+    ADCSRA |= 0b00011000;
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Called by the ADC interrupt, pass the conversion to the instance reading
+void MCUVoltage::handleADCInterrupt()
+{
+  MCUVoltage* instance = activeInstance;
+
+  // The interrupt only wakes the CPU up, the blocking reading picks up the result
+  if (asleep) { instance = NULL; }
+
+  if (instance != NULL) { instance->processConversion(); }
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+
+    // Nobody is reading, clear the flag so we do not get stuck in the ISR
+    else { ADC0.INTFLAGS = 0b00000001; }
+
+  #endif
+}
+
+
+/*================================================================================*/
+
+
@@ -16,24 +16,25 @@
 /*================================================================================*/
 
 
-void MCUVoltage::ADCSetup_OS(byte targetBitDepth)
+// Returns true if the ADC had to be set up, false if it already was.
+bool MCUVoltage::ADCSetup_OS(byte targetBitDepth)
 {
   
   // Oversampling at least one bit above the ADC bitdepth
   if (targetBitDepth <= bitDepth){ bitDepth_OS = bitDepth+1; }
   else { bitDepth_OS = targetBitDepth; }
 
-  // Update the resolution for oversampling
-  resolution_OS=intPow(2, bitDepth_OS);
+  // Update the resolution for oversampling, 2^bitDepth_OS
+  resolution_OS = 1UL << bitDepth_OS;
 
   // Update the extra bits from oversampling
   extraBits_OS = bitDepth_OS - bitDepth;
   
-  // We need this many samples for oversampling
-  sampleCount_OS=intPow(4, extraBits_OS );
+  // We need this many samples for oversampling, 4^extraBits_OS is 2^(2*extraBits_OS)
+  sampleCount_OS = 1U << (2*extraBits_OS);
 
   // Regular reading ADC setup
-  ADCSetup();
+  return ADCSetup();
 }
 
 
@@ -63,7 +64,7 @@ unsigned long MCUVoltage::readADC_OS()
 
 
 // Read Vcc with software oversampling once only.
-// Recommend to use the averaging method as it throws away the first reading.
+// Recommend to use the averaging method as it throws away readings until the bandgap settles.
 unsigned long MCUVoltage::readmV_OS(byte targetBitDepth)
 {
   mode = SOFTWARE_OVERSAMPLING;
@@ -73,7 +74,7 @@ unsigned long MCUVoltage::readmV_OS(byte targetBitDepth)
 
   // lastADCReading should be updated here
   readADC_OS(); 
-  return convertToVcc(bandgap, resolution_OS, lastADCReading);
+  return convertToVcc(lastADCReading, bitDepth_OS);
 }
 
 
@@ -81,7 +82,7 @@ unsigned long MCUVoltage::readmV_OS(byte targetBitDepth)
 
 
 // Read Vcc with software oversampling many times and average the readings. 
-// One reading is thrown away before averaging.
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
 unsigned long MCUVoltage::readmV_OS(byte targetBitDepth, byte avgTimes)
 {
   mode = SOFTWARE_OVERSAMPLING;
@@ -90,10 +91,9 @@ unsigned long MCUVoltage::readmV_OS(byte targetBitDepth, byte avgTimes)
   if (avgTimes <1){ avgTimes=1; }
   
   // Setup before reading ADC
+  // Throw away readings until the bandgap settles, only needed if the reference or mux was switched
   ADCSetup_OS(targetBitDepth);
-
-  // Throw away first reading
-  readADC();
+  settle();
 
   unsigned long sumOfAvg=0;
 
@@ -105,8 +105,132 @@ unsigned long MCUVoltage::readmV_OS(byte targetBitDepth, byte avgTimes)
   // Update lastADCReading
   lastADCReading = sumOfAvg / avgTimes;
   
-  return convertToVcc(bandgap, resolution_OS, lastADCReading);
+  return convertToVcc(lastADCReading, bitDepth_OS);
+
+}
+
+
+/*================================================================================*/
+
+
+// Get ready to read Vcc with software oversampling and averaging, a little at a time.
+// Call step() or stepMicros() until they return 100, then get the result with getmV().
+// Readings are thrown away until the bandgap settles if the reference or mux was switched.
+bool MCUVoltage::beginOversample(byte targetBitDepth, byte avgTimes)
+{
+  // ADC is being used by another reading
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = SOFTWARE_OVERSAMPLING;
+
+  // Min averaging times is 1
+  if (avgTimes <1){ avgTimes=1; }
+
+  ADCSetup_OS(targetBitDepth);
+  resetAccumulator(true, avgTimes);
+
+  // Readings thrown away while the bandgap settles count towards the progress too
+  conversionCount_Step = 0;
+  conversionTotal_Step = (settling ? settleCount : 0) + (unsigned long)avgTimes * sampleCount_OS;
+
+  stepping = true;
+  ready = false;
+  busy = true;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Do at most maxConversions conversions of the reading started by beginOversample().
+// Returns the progress from 0 to 100, 100 when the result is ready.
+byte MCUVoltage::step(unsigned int maxConversions)
+{
+  if (!stepping) { return ready ? 100 : 0; }
+
+  // Other code may have used the ADC since the last step,
+  // readings taken while the bandgap settles are thrown away by stepOnce()
+  ADCSetup();
+
+  for (unsigned int i=0; i<maxConversions; i++)
+  {
+    if (stepOnce()) { return 100; }
+  }
+
+  return getProgress();
+}
+
+
+/*================================================================================*/
+
+
+// Keep converting the reading started by beginOversample() for about maxMicros microseconds.
+// At least one conversion is done every call, so it may overrun by one conversion.
+// Returns the progress from 0 to 100, 100 when the result is ready.
+byte MCUVoltage::stepMicros(unsigned long maxMicros)
+{
+  if (!stepping) { return ready ? 100 : 0; }
+
+  // Other code may have used the ADC since the last step,
+  // readings taken while the bandgap settles are thrown away by stepOnce()
+  ADCSetup();
+
+  unsigned long start = micros();
+
+  do
+  {
+    if (stepOnce()) { return 100; }
+  }
+  while (micros() - start < maxMicros);
+
+  return getProgress();
+}
+
+
+/*================================================================================*/
+
+
+// Do one conversion of the time sliced reading, returns true when it is done
+bool MCUVoltage::stepOnce()
+{
+  unsigned long reading = readADC();
+  conversionCount_Step++;
+
+  // Throw away readings until the bandgap settles
+  if (settleFirst_Async && settling)
+  {
+    discardSettling(reading);
+    return false;
+  }
+
+  if (!accumulateReading(reading)) { return false; }
+
+  // All done, free up the ADC
+  activeInstance = NULL;
+  stepping = false;
+  busy = false;
+  ready = true;
+
+  if (callback != NULL) { callback(convertLastReading()); }
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Progress of the time sliced reading from 0 to 99, 100 is only for when it is done
+byte MCUVoltage::getProgress()
+{
+  byte progress = conversionCount_Step * 100 / conversionTotal_Step;
+
+  if (progress > 99) { progress = 99; }
 
+  return progress;
 }
 
 
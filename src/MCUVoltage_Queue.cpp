@@ -0,0 +1,318 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* ADC Sharing (Queue) Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// One queue, shared since there is only one ADC
+MCUVoltageRequest MCUVoltage::queue[MCUVOLTAGE_QUEUE_SIZE];
+byte              MCUVoltage::queueLength = 0;
+
+// Reference last set by the queue, not known at first
+byte              MCUVoltage::queueReference = 0xFF;
+
+// Vcc is read against Vcc, which is the DEFAULT reference of analogRead()
+#define VCC_REFERENCE DEFAULT
+
+
+/*================================================================================*/
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // ADC registers saved by saveADC()
+  static byte savedVREF, savedDACREF;
+  static byte savedCTRLA, savedCTRLB, savedCTRLC, savedCTRLD, savedCTRLE, savedCTRLF;
+  static byte savedCOMMAND, savedMUXPOS, savedMUXNEG, savedPGACTRL;
+
+  // Keep a copy of every register setupRegisters() may write
+  void MCUVoltage::saveADC()
+  {
+    savedVREF = VREF.CTRLA;
+    savedDACREF = AC0.DACREF;
+    savedCTRLA = ADC0.CTRLA;
+    savedCTRLB = ADC0.CTRLB;
+    savedCTRLC = ADC0.CTRLC;
+    savedCTRLD = ADC0.CTRLD;
+    savedCTRLE = ADC0.CTRLE;
+    savedCTRLF = ADC0.CTRLF;
+    savedCOMMAND = ADC0.COMMAND;
+    savedMUXPOS = ADC0.MUXPOS;
+    savedMUXNEG = ADC0.MUXNEG;
+    savedPGACTRL = ADC0.PGACTRL;
+  }
+
+  // Write back the registers saved by saveADC()
+  void MCUVoltage::restoreADC()
+  {
+    VREF.CTRLA = savedVREF;
+    AC0.DACREF = savedDACREF;
+    ADC0.MUXPOS = savedMUXPOS;
+    ADC0.MUXNEG = savedMUXNEG;
+    ADC0.PGACTRL = savedPGACTRL;
+    ADC0.CTRLB = savedCTRLB;
+    ADC0.CTRLC = savedCTRLC;
+    ADC0.CTRLD = savedCTRLD;
+    ADC0.CTRLE = savedCTRLE;
+    ADC0.CTRLF = savedCTRLF;
+
+    // Mode only, do not start a conversion
+    ADC0.COMMAND = savedCOMMAND & 0b11110000;
+
+    // Enable last, once everything else is in place
+    ADC0.CTRLA = savedCTRLA;
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // ADC registers saved by saveADC()
+  static byte savedVREF;
+  static byte savedCTRLA, savedCTRLB, savedCTRLC, savedCTRLD, savedCTRLE;
+  static byte savedSAMPCTRL, savedMUXPOS;
+
+  #if defined(VREF_ADC0REF)
+    static byte savedACREF;
+  #endif
+
+  #if defined(AC0_DACREF)
+    static byte savedDACREF;
+  #endif
+
+  // Keep a copy of every register setupRegisters() may write
+  void MCUVoltage::saveADC()
+  {
+    #if defined(VREF_ADC0REF)
+      savedVREF = VREF.ADC0REF;
+      savedACREF = VREF.ACREF;
+    #else
+      savedVREF = VREF.CTRLA;
+    #endif
+
+    #if defined(AC0_DACREF)
+      savedDACREF = AC0.DACREF;
+    #endif
+
+    savedCTRLA = ADC0.CTRLA;
+    savedCTRLB = ADC0.CTRLB;
+    savedCTRLC = ADC0.CTRLC;
+    savedCTRLD = ADC0.CTRLD;
+    savedCTRLE = ADC0.CTRLE;
+    savedSAMPCTRL = ADC0.SAMPCTRL;
+    savedMUXPOS = ADC0.MUXPOS;
+  }
+
+  // Write back the registers saved by saveADC()
+  void MCUVoltage::restoreADC()
+  {
+    #if defined(VREF_ADC0REF)
+      VREF.ADC0REF = savedVREF;
+      VREF.ACREF = savedACREF;
+    #else
+      VREF.CTRLA = savedVREF;
+    #endif
+
+    #if defined(AC0_DACREF)
+      AC0.DACREF = savedDACREF;
+    #endif
+
+    ADC0.MUXPOS = savedMUXPOS;
+    ADC0.CTRLB = savedCTRLB;
+    ADC0.CTRLC = savedCTRLC;
+    ADC0.CTRLD = savedCTRLD;
+    ADC0.CTRLE = savedCTRLE;
+    ADC0.SAMPCTRL = savedSAMPCTRL;
+
+    // Enable last, once everything else is in place, no conversion is started
+    ADC0.CTRLA = savedCTRLA;
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+#else
+
+  // ADC registers saved by saveADC()
+  static byte savedADMUX, savedADCSRA, savedADCSRB;
+
+  // Keep a copy of every register setupRegisters() may write
+  void MCUVoltage::saveADC()
+  {
+    savedADMUX = ADMUX;
+    savedADCSRA = ADCSRA;
+    savedADCSRB = ADCSRB;
+  }
+
+  // Write back the registers saved by saveADC()
+  void MCUVoltage::restoreADC()
+  {
+    ADMUX = savedADMUX;
+    ADCSRB = savedADCSRB;
+
+    // Leave ADSC (Bit 6) and ADIF (Bit 4) as 0, so no conversion is started
+    // and the interrupt flag is not cleared
+    ADCSRA = savedADCSRA & 0b10101111;
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Queue an analogRead() of pin against reference (as passed to analogReference()).
+// The reading is written to *reading by runQueue(). Returns false if the queue is full.
+bool MCUVoltage::queueAnalogRead(byte pin, byte reference, unsigned int* reading)
+{
+  if (queueLength >= MCUVOLTAGE_QUEUE_SIZE || reading == NULL) { return false; }
+
+  MCUVoltageRequest& request = queue[queueLength++];
+  request.instance = NULL;
+  request.pin = pin;
+  request.reference = reference;
+  request.avgTimes = 0;
+  request.reading = reading;
+  request.mV = NULL;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Queue a reading of Vcc, averaged avgTimes times like readmV(byte avgTimes).
+// Vcc in millivolts is written to *mV by runQueue(). Returns false if the queue is full.
+bool MCUVoltage::queueReading(unsigned long* mV, byte avgTimes)
+{
+  if (queueLength >= MCUVOLTAGE_QUEUE_SIZE || mV == NULL) { return false; }
+
+  // Min averaging times is 1
+  if (avgTimes <1){ avgTimes=1; }
+
+  MCUVoltageRequest& request = queue[queueLength++];
+  request.instance = this;
+  request.pin = 0;
+  request.reference = VCC_REFERENCE;
+  request.avgTimes = avgTimes;
+  request.reading = NULL;
+  request.mV = mV;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Do every queued reading. Readings with the same reference are done together,
+// starting with the reference already in use, so the reference switches as little as
+// possible. Within a reference, Vcc is read last so the mux only switches once, with the
+// ADC registers saved before and restored after so analogRead() is not disturbed.
+// Returns the number of readings done, 0 if a non-blocking reading is using the ADC.
+byte MCUVoltage::runQueue()
+{
+  // ADC is being used by a non-blocking reading
+  if (activeInstance != NULL) { return 0; }
+
+  byte done = 0;
+
+  while (queueLength > 0)
+  {
+    // Stay on the reference in use if any reading needs it, else take the oldest reading's
+    byte reference = queue[0].reference;
+
+    for (byte i=0; i<queueLength; i++)
+    {
+      if (queue[i].reference == queueReference) { reference = queueReference; break; }
+    }
+
+    bool switched = reference != queueReference;
+    queueReference = reference;
+    analogReference(reference);
+
+    // Pins first
+    for (byte i=0; i<queueLength; i++)
+    {
+      MCUVoltageRequest& request = queue[i];
+      if (request.reference != reference || request.instance != NULL) { continue; }
+
+      // The first reading after switching the reference is off, throw it away
+      if (switched)
+      {
+        analogRead(request.pin);
+        switched = false;
+      }
+
+      *request.reading = analogRead(request.pin);
+      done++;
+    }
+
+    // Then Vcc, restoring the ADC for analogRead() afterwards
+    bool saved = false;
+
+    for (byte i=0; i<queueLength; i++)
+    {
+      MCUVoltageRequest& request = queue[i];
+      if (request.reference != reference || request.instance == NULL) { continue; }
+
+      if (!saved)
+      {
+        saveADC();
+        saved = true;
+      }
+
+      *request.mV = request.instance->readmV(request.avgTimes);
+      done++;
+    }
+
+    if (saved) { restoreADC(); }
+
+    // Remove the readings done, keeping the order of the rest
+    byte kept = 0;
+
+    for (byte i=0; i<queueLength; i++)
+    {
+      if (queue[i].reference != reference) { queue[kept++] = queue[i]; }
+    }
+
+    queueLength = kept;
+  }
+
+  return done;
+}
+
+
+/*================================================================================*/
+
+
+// Throw away every queued reading
+void MCUVoltage::clearQueue()
+{
+  queueLength = 0;
+}
+
+
+/*================================================================================*/
+
+
+// Number of readings waiting in the queue
+byte MCUVoltage::getQueueLength()
+{
+  return queueLength;
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,411 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Background (Free Running) Sampler Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Ring buffer is empty when head and tail are the same
+volatile unsigned int MCUVoltage::sampleBuffer[MCUVOLTAGE_BUFFER_SIZE];
+volatile byte         MCUVoltage::sampleHead = 0;
+volatile byte         MCUVoltage::sampleTail = 0;
+volatile unsigned int MCUVoltage::droppedSamples = 0;
+
+// Free running until setSamplingRate() is used
+unsigned long         MCUVoltage::samplingRate = 0;
+unsigned int          MCUVoltage::samplingTop = 0;
+byte                  MCUVoltage::samplingClock = 0;
+
+// Used to wrap the ring buffer index around
+#define BUFFER_MASK (MCUVOLTAGE_BUFFER_SIZE - 1)
+
+
+/*================================================================================*/
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // Timer that starts the conversions through the event system
+  #if MCUVOLTAGE_SAMPLING_TCB == 1
+    #define SAMPLING_TCB TCB1
+    #define SAMPLING_GENERATOR 0xA2 // TCB1_CAPT
+  #else
+    #define SAMPLING_TCB TCB0
+    #define SAMPLING_GENERATOR 0xA0 // TCB0_CAPT
+  #endif
+
+  // CLK_PER is divided by these, index is CLKSEL of TCBn.CTRLA
+  static const byte timerPrescalers[] = {1, 2};
+
+  // Start the ADC on every TCB period, routed through the last event channel
+  // (the Event library of megaTinyCore hands out channels from 0)
+  void MCUVoltage::startSamplingTimer()
+  {
+    SAMPLING_TCB.CTRLA = 0;
+    SAMPLING_TCB.CTRLB = 0; // Periodic interrupt mode, CAPT event on every CCMP match
+    SAMPLING_TCB.CCMP = samplingTop;
+    SAMPLING_TCB.CNT = 0;
+
+    EVSYS.CHANNEL5 = SAMPLING_GENERATOR;
+    EVSYS.USERADC0START = 5 + 1; // Channel n is n+1
+
+    // Start on event (START is 4), keep the mode
+    ADC0.COMMAND = (ADC0.COMMAND & 0b11111000) | 0b00000100;
+
+    // Enable (Bit 0) with CLKSEL (Bit 3:1)
+    SAMPLING_TCB.CTRLA = (samplingClock << 1) | 0b00000001;
+  }
+
+  void MCUVoltage::stopSamplingTimer()
+  {
+    SAMPLING_TCB.CTRLA = 0;
+    EVSYS.USERADC0START = 0;
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // The event system is laid out differently on each of these, so no timer starts
+  // the ADC and setSamplingRate() leaves it free running. Never called.
+  void MCUVoltage::startSamplingTimer() {}
+  void MCUVoltage::stopSamplingTimer() {}
+
+
+//******************** TRADITIONAL MCU ********************//
+#else
+
+  // CLK_IO is divided by these, index + 1 is CS12:0 of TCCR1B
+  static const unsigned int timerPrescalers[] = {1, 8, 64, 256, 1024};
+
+  // Start the ADC on every Timer1 compare match B, with Timer1 in CTC mode
+  void MCUVoltage::startSamplingTimer()
+  {
+    // Stop Timer1 first, then count up to OCR1A and start again from 0 (WGM12, Bit 3)
+    TCCR1B = 0;
+    TCCR1A = 0;
+    OCR1A = samplingTop;
+    OCR1B = samplingTop;
+    TCNT1 = 0;
+
+    // Clear OCF1B (Bit 2), the ADC only starts when it goes from 0 to 1
+    TIFR1 = 0b00000100;
+
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+
+      // Timer1 compare match B is 0101 for ADTS3:0
+      ADCSRB = (ADCSRB & 0b11110000) | 0b00000101;
+
+    #else
+
+      // Timer1 compare match B is 101 for ADTS2:0
+      ADCSRB = (ADCSRB & 0b11111000) | 0b00000101;
+
+    #endif
+
+    TCCR1B = 0b00001000 | (samplingClock + 1);
+  }
+
+  void MCUVoltage::stopSamplingTimer()
+  {
+    TCCR1B = 0;
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Set how many samples per second beginSampling() takes, started by a timer instead of
+// free running. Pass 0 to go back to free running. Applied on the next beginSampling().
+// Returns the closest rate the timer and the ADC clock (in the registers now) can do.
+unsigned long MCUVoltage::setSamplingRate(unsigned long rateHz)
+{
+  unsigned long maxRate = getConversionsPerSecond();
+
+  if (rateHz == 0)
+  {
+    samplingRate = 0;
+    return maxRate;
+  }
+
+  #if MCUVOLTAGE_SAMPNUM_ADC
+
+    // No timer on the tinyAVR 0/1, megaAVR 0 and AVR Dx, stays free running
+    samplingRate = 0;
+    return 0;
+
+  #else
+
+  // A trigger while the ADC is busy is lost, so no faster than the ADC
+  if (rateHz > maxRate) { rateHz = maxRate; }
+
+  // Smallest prescaler that fits the period in 16 bits, else the slowest rate there is
+  const byte    lastClock = sizeof(timerPrescalers) / sizeof(timerPrescalers[0]) - 1;
+  byte          clock = 0;
+  unsigned long period = (F_CPU + rateHz/2) / rateHz;
+
+  while (clock < lastClock && period > 65536UL)
+  {
+    clock++;
+    period = (F_CPU / timerPrescalers[clock] + rateHz/2) / rateHz;
+  }
+
+  if (period > 65536UL) { period = 65536UL; }
+  if (period < 1) { period = 1; }
+
+  // Rounding may have gone just past the ADC
+  if (period < 65536UL && (F_CPU / timerPrescalers[clock] + period/2) / period > maxRate) { period++; }
+
+  samplingClock = clock;
+  samplingTop = period - 1;
+  samplingRate = (F_CPU / timerPrescalers[clock] + period/2) / period;
+
+  return samplingRate;
+
+  #endif
+}
+
+
+/*================================================================================*/
+
+
+// Samples per second set by setSamplingRate(), 0 if free running
+unsigned long MCUVoltage::getSamplingRate()
+{
+  return samplingRate;
+}
+
+
+/*================================================================================*/
+
+
+// Put the ADC in free running mode, or have a timer start it at the rate set by
+// setSamplingRate(), and keep the samples in the ring buffer
+bool MCUVoltage::beginSampling()
+{
+  // ADC is being used by another reading
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = REGULAR_READING;
+
+  // Throw away readings until the bandgap settles if the reference or mux was switched, the ISR keeps the rest
+  ADCSetup();
+  settleFirst_Async = true;
+
+  // Empty the buffer
+  sampleHead = 0;
+  sampleTail = 0;
+  droppedSamples = 0;
+
+  // streamSamples() starts with a header again
+  sequence_Stream = 0;
+  dropped_Stream = 0;
+
+  sampling = true;
+  ready = false;
+  busy = true;
+
+  // Timed by a timer, the ADC interrupt does the rest
+  if (samplingRate != 0)
+  {
+    enableADCInterrupt();
+    startSamplingTimer();
+
+    #if !defined(__AVR_ATtiny3224__) && !defined(__AVR_ATtiny3226__) && !defined(__AVR_ATtiny3227__) && !MCUVOLTAGE_SAMPNUM_ADC
+
+      // Enable auto trigger (Bit 5), conversions start on the compare match
+      ADCSRA |= 0b00100000;
+
+    #endif
+
+    return true;
+  }
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+    // Enable freerun (Bit 5), keep single sample
+    ADC0.CTRLF |= 0b00100000;
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    // Enable freerun (Bit 1), keep single sample
+    ADC0.CTRLA |= 0b00000010;
+
+  #else
+
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+
+      // Auto trigger source is free running when ADTS3:0 are cleared
+      ADCSRB &= 0b11110000;
+
+    #else
+
+      // Auto trigger source is free running when ADTS2:0 are cleared
+      ADCSRB &= 0b11111000;
+
+    #endif
+
+    // Enable auto trigger (Bit 5)
+    ADCSRA |= 0b00100000;
+
+  #endif
+
+  enableADCInterrupt();
+  startConversion();
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Take the ADC out of free running mode, samples in the buffer can still be read
+void MCUVoltage::stopSampling()
+{
+  if (activeInstance != this || !sampling) { return; }
+
+  disableADCInterrupt();
+
+  if (samplingRate != 0) { stopSamplingTimer(); }
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+    // Disable freerun and stop the conversion
+    ADC0.CTRLF &= ~(0b00100000);
+    ADC0.COMMAND &= ~(0b00000111);
+
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+
+    // Disable freerun, then let the conversion in progress finish and throw it away,
+    // else the next blocking reading takes it as its first reading
+    ADC0.CTRLA &= ~(0b00000010);
+    while ( ADC0.COMMAND & 0b00000001 ){}
+    ADC0.INTFLAGS = 0b00000001;
+
+  #else
+
+    // Disable auto trigger ~(0b00100000) is 0b11011111
+    ADCSRA &= 0b11011111;
+
+    // Let the conversion in progress finish (ADSC, Bit 6) and clear its ADIF (Bit 4) by writing 1,
+    // else the next blocking reading takes it as its first reading
+    while ( ADCSRA & 0b01000000 ){}
+    ADCSRA |= 0b00010000;
+
+  #endif
+
+  sampling = false;
+  busy = false;
+  activeInstance = NULL;
+}
+
+
+/*================================================================================*/
+
+
+bool MCUVoltage::isSampling()
+{
+  return sampling;
+}
+
+
+/*================================================================================*/
+
+
+// Runs inside the ISR, the ISR is the only one moving the head
+void MCUVoltage::pushSample(unsigned int sample)
+{
+  byte nextHead = (sampleHead + 1) & BUFFER_MASK;
+
+  // Buffer full, drop the new sample rather than overwrite the unread ones
+  if (nextHead == sampleTail)
+  {
+    droppedSamples++;
+    return;
+  }
+
+  sampleBuffer[sampleHead] = sample;
+  sampleHead = nextHead; // Publish the sample only after it is written
+}
+
+
+/*================================================================================*/
+
+
+// Number of samples waiting in the buffer
+byte MCUVoltage::available()
+{
+  return (sampleHead - sampleTail) & BUFFER_MASK;
+}
+
+
+/*================================================================================*/
+
+
+// Move up to maxSamples raw readings from the ring buffer into buffer.
+// Returns the number of samples moved. Only this moves the tail.
+byte MCUVoltage::readSamples(unsigned int* buffer, byte maxSamples)
+{
+  byte head = sampleHead; // Take a copy once, the ISR may move it
+  byte tail = sampleTail;
+  byte count = 0;
+
+  while (tail != head && count < maxSamples)
+  {
+    buffer[count++] = sampleBuffer[tail];
+    tail = (tail + 1) & BUFFER_MASK;
+  }
+
+  sampleTail = tail; // Free up the slots only after they are read
+
+  if (count > 0) { lastADCReading = buffer[count-1]; }
+
+  return count;
+}
+
+
+/*================================================================================*/
+
+
+// Convert raw readings from readSamples() to Vcc in millivolts
+void MCUVoltage::convertSamples(const unsigned int* samples, unsigned long* mV, byte count)
+{
+  for (byte i=0; i<count; i++)
+  {
+    mV[i] = convertToVcc(samples[i]);
+  }
+}
+
+
+/*================================================================================*/
+
+
+// Number of samples thrown away because the buffer was full
+unsigned int MCUVoltage::getDroppedSamples()
+{
+  // unsigned int is two bytes, do not let the ISR change it halfway
+  byte oldSREG = SREG;
+  cli();
+  unsigned int count = droppedSamples;
+  SREG = oldSREG;
+
+  return count;
+}
+
+
+/*================================================================================*/
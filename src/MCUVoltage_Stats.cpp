@@ -0,0 +1,80 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Instrumentation Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Compiled only when asked for, so it costs nothing otherwise
+#if MCUVOLTAGE_STATS
+
+// Shared since there is only one ADC, minRaw starts high so the first conversion replaces it
+MCUVoltageStats MCUVoltage::stats = { {0, 0, 0}, 0, 0, 0, 0xFFFFFFFF, 0, 0 };
+
+
+/*================================================================================*/
+
+
+// Count one conversion in the given mode, with the microseconds spent waiting on it.
+// Also runs inside the ISR.
+void MCUVoltage::countConversion(byte myMode, unsigned long reading, unsigned long busyMicros)
+{
+  stats.conversions[myMode]++;
+  stats.busyMicros += busyMicros;
+  stats.lastRaw = reading;
+
+  if (reading < stats.minRaw) { stats.minRaw = reading; }
+  if (reading > stats.maxRaw) { stats.maxRaw = reading; }
+}
+
+
+/*================================================================================*/
+
+
+// Copy of the counters, taken with interrupts off so the ISR cannot change them halfway
+MCUVoltageStats MCUVoltage::getStats()
+{
+  byte oldSREG = SREG;
+  cli();
+
+  MCUVoltageStats copy = stats;
+
+  SREG = oldSREG;
+
+  return copy;
+}
+
+
+/*================================================================================*/
+
+
+// Start counting again from zero
+void MCUVoltage::resetStats()
+{
+  byte oldSREG = SREG;
+  cli();
+
+  for (byte i=0; i<3; i++) { stats.conversions[i] = 0; }
+
+  stats.discarded = 0;
+  stats.setups = 0;
+  stats.busyMicros = 0;
+  stats.minRaw = 0xFFFFFFFF;
+  stats.maxRaw = 0;
+  stats.lastRaw = 0;
+
+  SREG = oldSREG;
+}
+
+
+/*================================================================================*/
+
+#endif
@@ -0,0 +1,134 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Binary Streaming Methods */
+
+/*
+ * Frames written by streamSamples(), multi-byte fields are little endian:
+ *
+ *   Header: 0xA5 'H' version device bitDepth bandgap(2) bandgap_Compensated(2) offset(2) rate(4) crc
+ *   Data:   0xA5 'D' sequence count dropped(varint) first(varint) delta(varint)... crc
+ *
+ * first is the raw reading of the first sample, every delta is the next reading minus the one
+ * before, zig-zag encoded so small changes either way take one byte. Varints are 7 bits a byte,
+ * lowest first, with bit 7 set on every byte but the last. The CRC-8 (polynomial 0x07) covers
+ * every byte after 0xA5. extras/host/stream_decode.cpp turns the frames back into CSV.
+ */
+
+
+#include "MCUVoltage.h"
+
+
+// Sequence 0 sends the header first
+byte         MCUVoltage::sequence_Stream = 0;
+unsigned int MCUVoltage::dropped_Stream = 0;
+
+// First byte of every frame, and the frame types after it
+#define SYNC_STREAM    0xA5
+#define HEADER_STREAM  'H'
+#define DATA_STREAM    'D'
+#define VERSION_STREAM 1
+
+// Longest data frame, every varint of 16 bits takes at most 3 bytes
+#define FRAME_BYTES_STREAM (4 + 3 + 3 * MCUVOLTAGE_STREAM_FRAME_SIZE + 1)
+
+
+/*================================================================================*/
+
+
+// Write value as a varint into frame, returns the number of bytes written
+static byte putVarint(byte* frame, unsigned int value)
+{
+  byte length = 0;
+
+  while (value >= 0x80)
+  {
+    frame[length++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+
+  frame[length++] = value;
+
+  return length;
+}
+
+
+/*================================================================================*/
+
+
+// Write what the decoder needs to turn raw readings into millivolts, the same values
+// convertToVcc() uses, so calibration and temperature compensation are carried over
+void MCUVoltage::writeHeader_Stream(Print& output)
+{
+  unsigned long rate = samplingRate != 0 ? samplingRate : getConversionsPerSecond();
+
+  byte frame[15] =
+  {
+    SYNC_STREAM, HEADER_STREAM, VERSION_STREAM, device, bitDepth,
+    (byte)bandgap, (byte)(bandgap >> 8),
+    (byte)bandgap_Compensated, (byte)(bandgap_Compensated >> 8),
+    (byte)offset_Calibration, (byte)((unsigned int)offset_Calibration >> 8),
+    (byte)rate, (byte)(rate >> 8), (byte)(rate >> 16), (byte)(rate >> 24)
+  };
+
+  output.write(frame, sizeof(frame));
+  output.write(crc8(frame + 1, sizeof(frame) - 1));
+}
+
+
+/*================================================================================*/
+
+
+// Move up to MCUVOLTAGE_STREAM_FRAME_SIZE samples from the background sampler to output as
+// one binary frame, with a header first on the first frame and every 256 frames after.
+// Returns the number of samples written, nothing is written if there are none.
+byte MCUVoltage::streamSamples(Print& output)
+{
+  unsigned int samples[MCUVOLTAGE_STREAM_FRAME_SIZE];
+  byte count = readSamples(samples, MCUVOLTAGE_STREAM_FRAME_SIZE);
+
+  if (count == 0) { return 0; }
+
+  // Again when the sequence wraps, so a decoder started late still gets it
+  if (sequence_Stream == 0) { writeHeader_Stream(output); }
+
+  byte frame[FRAME_BYTES_STREAM];
+  byte length = 0;
+
+  frame[length++] = SYNC_STREAM;
+  frame[length++] = DATA_STREAM;
+  frame[length++] = sequence_Stream++;
+  frame[length++] = count;
+
+  // Samples thrown away since the last frame, the decoder skips them in the sample count
+  unsigned int dropped = getDroppedSamples();
+  length += putVarint(frame + length, dropped - dropped_Stream);
+  dropped_Stream = dropped;
+
+  length += putVarint(frame + length, samples[0]);
+
+  for (byte i=1; i<count; i++)
+  {
+    // Zig-zag, 0, -1, 1, -2... become 0, 1, 2, 3...
+    int delta = (int)samples[i] - (int)samples[i-1];
+    unsigned int zigzag = delta >= 0 ? (unsigned int)delta << 1 : ((unsigned int)(-delta) << 1) - 1;
+
+    length += putVarint(frame + length, zigzag);
+  }
+
+  frame[length] = crc8(frame + 1, length - 1);
+  length++;
+
+  output.write(frame, length);
+
+  return count;
+}
+
+
+/*================================================================================*/
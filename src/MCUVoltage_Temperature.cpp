@@ -0,0 +1,282 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Temperature Compensation Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Shared, there is only one sensor. Not known until it is read.
+int           MCUVoltage::temperature = 25;
+unsigned long MCUVoltage::temperatureMillis = 0;
+bool          MCUVoltage::temperatureKnown = false;
+
+
+/*================================================================================*/
+
+
+#if MCUVOLTAGE_TEMPERATURE_SENSOR
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // The sensor needs a sample duration of at least 32us, this is enough up to a CLK_ADC of 3MHz
+  #define SAMPDUR_TEMPERATURE 100
+
+  // Read the temperature sensor once, in degrees Celsius, with the factory calibration in SIGROW.
+  // The ADC is left for setupRegisters() to set up again for Vcc.
+  static int convertTemperature()
+  {
+    byte savedCTRLE = ADC0.CTRLE;
+
+    // Temperature sensor as input, against the internal 1.024V reference (REFSEL 100)
+    ADC0.CTRLA |= 0b00000001;
+    ADC0.MUXPOS = 0b00110010;
+    ADC0.CTRLC = (ADC0.CTRLC & 0b11111000) | 0b00000100;
+    ADC0.CTRLF = 0b00000000;
+    ADC0.CTRLE = SAMPDUR_TEMPERATURE;
+
+    // Single 12 bit, no accumulation
+    ADC0.COMMAND = 0b00010000;
+
+    delayMicroseconds(MCUVOLTAGE_TEMPERATURE_SETTLE_US);
+
+    ADC0.COMMAND |= 0b00000001;
+    while ( ADC0.STATUS > 0 ){}
+    unsigned int reading = ADC0.RESULT;
+
+    ADC0.CTRLE = savedCTRLE;
+
+    // Kelvin = ((offset - reading)*gain + 0x800) >> 12, as in the datasheet
+    unsigned int gain = SIGROW.TEMPSENSE0;
+    unsigned int offset = SIGROW.TEMPSENSE1;
+
+    long kelvin = (((long)offset - reading) * gain + 0x800) >> 12;
+
+    return kelvin - 273;
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // The sensor needs a sample time of at least 32us, this is enough up to a CLK_ADC of
+  // 3MHz (AVR Dx, SAMPLEN has 8 bits) or 1MHz (others, SAMPLEN has 5 bits)
+  #if defined(VREF_ADC0REF)
+    #define SAMPLEN_TEMPERATURE 100
+  #else
+    #define SAMPLEN_TEMPERATURE 31
+  #endif
+
+  // Read the temperature sensor once, in degrees Celsius, with the factory calibration in SIGROW.
+  // The ADC is left for setupRegisters() to set up again for Vcc.
+  static int convertTemperature()
+  {
+    byte savedSAMPCTRL = ADC0.SAMPCTRL;
+
+    #if defined(VREF_ADC0REF)
+
+      // Internal 2.048V reference (REFSEL 001), keep ALWAYSON
+      VREF.ADC0REF = (VREF.ADC0REF & 0b11111000) | 0b00000001;
+
+      // Temperature sensor as input
+      ADC0.MUXPOS = 0b01000010;
+
+    #else
+
+      // Set the ADC0 reference (Bit 6:4) to 1.1V
+      VREF.CTRLA = (VREF.CTRLA & 0b10001111) | 0b00010000;
+
+      // Internal reference (Bit 5:4) with the smaller sample capacitor (Bit 6), keep the prescaler
+      ADC0.CTRLC = (ADC0.CTRLC & 0b00000111) | 0b01000000;
+
+      // Temperature sensor as input
+      ADC0.MUXPOS = 0b00011110;
+
+    #endif
+
+    // Single sample at full resolution
+    ADC0.CTRLB = 0b00000000;
+    ADC0.CTRLA = 0b00000001;
+    ADC0.SAMPCTRL = SAMPLEN_TEMPERATURE;
+
+    delayMicroseconds(MCUVOLTAGE_TEMPERATURE_SETTLE_US);
+
+    ADC0.COMMAND = 0b00000001;
+    while ( ADC0.COMMAND & 0b00000001 ){}
+    unsigned int reading = ADC0.RES;
+
+    ADC0.SAMPCTRL = savedSAMPCTRL;
+
+    #if defined(VREF_ADC0REF)
+
+      // Kelvin = ((offset - reading)*gain + 0x800) >> 12, as in the datasheet
+      unsigned int gain = SIGROW.TEMPSENSE0;
+      unsigned int offset = SIGROW.TEMPSENSE1;
+
+      long kelvin = (((long)offset - reading) * gain + 0x800) >> 12;
+
+    #else
+
+      // Kelvin = ((reading - offset)*gain + 0x80) >> 8, as in the datasheet, the offset is signed
+      byte gain = SIGROW.TEMPSENSE0;
+      signed char offset = SIGROW.TEMPSENSE1;
+
+      long kelvin = (((long)reading - offset) * gain + 0x80) >> 8;
+
+    #endif
+
+    return kelvin - 273;
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+// Compile only for ATmega16u4/32u4,
+// 328/328P, 48/48P, 88/88P, 168/168P
+#else
+
+  // Read the temperature sensor once, in degrees Celsius, from the typical values in the datasheet.
+  // Not calibrated, so it can be off by about 10 degrees, which moves the bandgap very little.
+  // The ADC is left for setupRegisters() to set up again for Vcc.
+  static int convertTemperature()
+  {
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+
+      // Internal 2.56V reference (Bit 7:6), MUX5:0 100111, right adjusted
+      ADMUX = 0b11000111;
+      ADCSRB |= 0b00100000;
+
+    #else
+
+      // Internal 1.1V reference (Bit 7:6), MUX3:0 1000, right adjusted
+      ADMUX = 0b11001000;
+
+    #endif
+
+    // Enable ADC (Bit 7), disable auto trigger (Bit 5)
+    ADCSRA |= 0b10000000;
+    ADCSRA &= 0b11011111;
+
+    delayMicroseconds(MCUVOLTAGE_TEMPERATURE_SETTLE_US);
+
+    ADCSRA |= 0b01000000;
+    while((ADCSRA & 0b01000000) > 0){}
+
+    unsigned int reading = ADCL;
+    reading |= ADCH<<8;
+
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+
+      // 2.5mV per step, 880mV at 25 degrees and about 3.25mV per degree
+      long mV = (reading * 5UL) >> 1;
+      return 25 + ((mV - 880) * 4) / 13;
+
+    #else
+
+      // 1100/1024mV per step, 314mV at 25 degrees and about 1mV per degree
+      long mV = (reading * 1100UL + 512) >> 10;
+      return mV - 289;
+
+    #endif
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Read the temperature sensor with one conversion, in degrees Celsius.
+// Returns the last temperature without reading if a non-blocking reading is using the ADC.
+int MCUVoltage::readTemperature()
+{
+  if (activeInstance != NULL) { return temperature; }
+
+  // Prescaler and sample duration of the timing profile
+  setupTiming();
+
+  temperature = convertTemperature();
+  temperatureMillis = millis();
+  temperatureKnown = true;
+
+  return temperature;
+}
+
+
+/*================================================================================*/
+
+
+// Last temperature read, in degrees Celsius
+int MCUVoltage::getTemperature()
+{
+  return temperature;
+}
+
+
+/*================================================================================*/
+
+
+// Follow the temperature with the bandgap, ppmPerC parts per million per degree Celsius away
+// from referenceC, the temperature the bandgap was set or calibrated at. The temperature is
+// read again before a reading once it is older than refreshMillis. 0 ppmPerC turns it off.
+// Returns false if ppmPerC is more than 1000 either way.
+bool MCUVoltage::setTemperatureCompensation(int ppmPerC, int referenceC, unsigned long refreshMillis)
+{
+  if (ppmPerC > 1000 || ppmPerC < -1000) { return false; }
+
+  tempco_Temperature = ppmPerC;
+  reference_Temperature = referenceC;
+  refresh_Temperature = refreshMillis;
+
+  // Use the temperature already read, if any, else it is read on the next reading
+  compensate();
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Parts per million per degree Celsius set by setTemperatureCompensation(), 0 if off
+int MCUVoltage::getTemperatureCompensation()
+{
+  return tempco_Temperature;
+}
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Called before every reading sets up the ADC. Reads the temperature if it is older than the
+// refresh interval, and moves the bandgap only if the temperature changed.
+void MCUVoltage::refreshTemperature()
+{
+  #if MCUVOLTAGE_TEMPERATURE_SENSOR
+
+    if (tempco_Temperature == 0) { return; }
+
+    if (!temperatureKnown || millis() - temperatureMillis >= refresh_Temperature)
+    {
+      readTemperature();
+    }
+
+    // Another instance may have read it, follow it too
+    if (temperature != used_Temperature) { compensate(); }
+
+  #endif
+}
+
+
+/*================================================================================*/
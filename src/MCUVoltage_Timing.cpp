@@ -0,0 +1,286 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* ADC Timing and Bandgap Settling Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Shared, there is only one ADC. Leave the timing to the core by default.
+byte MCUVoltage::timing = TIMING_UNCHANGED;
+
+// Nothing to settle until the ADC is set up
+volatile bool MCUVoltage::settling = false;
+volatile byte MCUVoltage::settleCount = 0;
+unsigned long MCUVoltage::switchMicros = 0;
+unsigned long MCUVoltage::settleReading = 0;
+volatile byte MCUVoltage::settleMatches = 0;
+
+
+/*================================================================================*/
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // CLK_PER is divided by these for CLK_ADC, index is the PRESC bits in CTRLB
+  static const byte prescalers[] PROGMEM = {2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64};
+
+  // Fastest CLK_ADC and sample duration (SAMPDUR) for each profile, in profile order
+  static const unsigned long maxADCClock[] = {0, 5000000UL, 2500000UL, 1000000UL};
+  static const byte          sampleDuration[] = {0, 0, 4, 16};
+
+  // Write the prescaler, sample duration and timebase of the profile, if they are not already there
+  void MCUVoltage::setupTiming()
+  {
+    if (timing == TIMING_UNCHANGED) { return; }
+
+    // Smallest divider that keeps CLK_ADC within the profile, else the largest divider
+    byte presc = 0;
+    while ( presc < 15 && F_CPU / pgm_read_byte(&prescalers[presc]) > maxADCClock[timing] ) { presc++; }
+
+    // TIMEBASE is the number of CLK_PER cycles in 1us, rounded up,
+    // the ADC uses it to time its start up and reference settling
+    byte timebase = (F_CPU + 999999UL) / 1000000UL;
+    if (timebase > 31) { timebase = 31; }
+
+    if ( (ADC0.CTRLB & 0b00001111) != presc ) { ADC0.CTRLB = presc; }
+
+    if ( ADC0.CTRLE != sampleDuration[timing] ) { ADC0.CTRLE = sampleDuration[timing]; }
+
+    // TIMEBASE is Bit 7:3, leave REFSEL alone
+    if ( (ADC0.CTRLC >> 3) != timebase ) { ADC0.CTRLC = (timebase << 3) | (ADC0.CTRLC & 0b00000111); }
+  }
+
+  // Single 12 bit conversions per second with the prescaler and sample duration in the registers
+  unsigned long MCUVoltage::getConversionsPerSecond()
+  {
+    unsigned long ADCClock = F_CPU / pgm_read_byte(&prescalers[ADC0.CTRLB & 0b00001111]);
+
+    // About 2 cycles to start sampling, SAMPDUR more to sample, and 13 to convert
+    return ADCClock / (15 + ADC0.CTRLE);
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  #if defined(VREF_ADC0REF)
+
+    // AVR Dx: CLK_PER is divided by these for CLK_ADC, index is the PRESC bits (Bit 3:0) of CTRLC
+    static const unsigned int prescalers[] PROGMEM = {2, 4, 8, 12, 16, 20, 24, 28, 32, 48, 64, 96, 128, 256};
+    #define PRESC_MASK 0b00001111
+
+    // 2 cycles to sample and 13 to convert 12 bits
+    #define CONVERSION_CYCLES 15
+
+    // Fastest CLK_ADC for each profile, in profile order
+    static const unsigned long maxADCClock[] = {0, 2000000UL, 1000000UL, 250000UL};
+
+  #else
+
+    // tinyAVR 0/1-series and megaAVR 0-series: CLK_PER is divided by these for CLK_ADC,
+    // index is the PRESC bits (Bit 2:0) of CTRLC
+    static const unsigned int prescalers[] PROGMEM = {2, 4, 8, 16, 32, 64, 128, 256};
+    #define PRESC_MASK 0b00000111
+
+    // 13 cycles to sample and convert 10 bits
+    #define CONVERSION_CYCLES 13
+
+    // Fastest CLK_ADC for each profile, in profile order, 1.5MHz and below gives the full 10 bits
+    static const unsigned long maxADCClock[] = {0, 1500000UL, 1000000UL, 250000UL};
+
+  #endif
+
+  // Sample length (SAMPLEN) added for each profile, in profile order
+  static const byte sampleLength[] = {0, 0, 4, 16};
+
+  // Write the prescaler and sample length of the profile, if they are not already there
+  void MCUVoltage::setupTiming()
+  {
+    if (timing == TIMING_UNCHANGED) { return; }
+
+    // Smallest divider that keeps CLK_ADC within the profile, else the largest divider
+    const byte lastPresc = sizeof(prescalers) / sizeof(prescalers[0]) - 1;
+    byte presc = 0;
+    while ( presc < lastPresc && F_CPU / pgm_read_word(&prescalers[presc]) > maxADCClock[timing] ) { presc++; }
+
+    // Leave the reference and sample capacitor alone
+    if ( (ADC0.CTRLC & PRESC_MASK) != presc ) { ADC0.CTRLC = (ADC0.CTRLC & ~PRESC_MASK) | presc; }
+
+    if ( ADC0.SAMPCTRL != sampleLength[timing] ) { ADC0.SAMPCTRL = sampleLength[timing]; }
+  }
+
+  // Single conversions per second with the prescaler and sample length in the registers
+  unsigned long MCUVoltage::getConversionsPerSecond()
+  {
+    // PRESC past the table is reserved on the AVR Dx
+    const byte lastPresc = sizeof(prescalers) / sizeof(prescalers[0]) - 1;
+    byte presc = ADC0.CTRLC & PRESC_MASK;
+    if (presc > lastPresc) { presc = lastPresc; }
+
+    unsigned long ADCClock = F_CPU / pgm_read_word(&prescalers[presc]);
+
+    return ADCClock / (CONVERSION_CYCLES + ADC0.SAMPCTRL);
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+// Compile only for ATmega16u4/32u4,
+// 328/328P, 48/48P, 88/88P, 168/168P
+#else
+
+  // Fastest ADC clock for each profile, in profile order
+  // 200kHz and below gives the full 10 bits, up to 1MHz loses some
+  static const unsigned long maxADCClock[] = {0, 1000000UL, 200000UL, 100000UL};
+
+  // Write the prescaler of the profile, if it is not already there
+  void MCUVoltage::setupTiming()
+  {
+    if (timing == TIMING_UNCHANGED) { return; }
+
+    // ADPS2:0 of 1 to 7 divides the clock by 2^ADPS, smallest divider
+    // that keeps the ADC clock within the profile, else divide by 128
+    byte ADPS = 1;
+    while ( ADPS < 7 && (F_CPU >> ADPS) > maxADCClock[timing] ) { ADPS++; }
+
+    // Leave ADIF alone (Bit 4), writing a 1 to it clears it
+    if ( (ADCSRA & 0b00000111) != ADPS ) { ADCSRA = (ADCSRA & 0b11101000) | ADPS; }
+  }
+
+  // Conversions per second with the prescaler in the registers
+  unsigned long MCUVoltage::getConversionsPerSecond()
+  {
+    // ADPS2:0 of 0 divides by 2 as well
+    byte ADPS = ADCSRA & 0b00000111;
+    if (ADPS == 0) { ADPS = 1; }
+
+    // A normal conversion takes 13 ADC clock cycles
+    return (F_CPU >> ADPS) / 13;
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Most conversions that cover the time the bandgap needs to settle, at least 1
+byte MCUVoltage::settlingConversions()
+{
+  unsigned long conversions = (getConversionsPerSecond() * MCUVOLTAGE_SETTLE_US + 999999UL) / 1000000UL;
+
+  if (conversions < 1) { return 1; }
+  if (conversions > 255) { return 255; }
+
+  return conversions;
+}
+
+
+/*================================================================================*/
+
+
+// Called when the reference or mux is switched, the bandgap needs time to settle from now
+void MCUVoltage::startSettling()
+{
+  switchMicros = micros();
+
+  // Upper limit, in case micros() stops while the CPU sleeps
+  settleCount = settlingConversions();
+
+  // The first reading never matches this
+  settleReading = 0xFFFFFFFFUL;
+  settleMatches = 0;
+
+  settling = true;
+}
+
+
+/*================================================================================*/
+
+
+// True while the bandgap is still settling
+bool MCUVoltage::isSettling()
+{
+  if (settling && micros() - switchMicros >= MCUVOLTAGE_SETTLE_US) { settling = false; }
+
+  return settling;
+}
+
+
+/*================================================================================*/
+
+
+// Throw away a reading taken while the bandgap settles. Settling is done once enough
+// time has passed since the switch, MCUVOLTAGE_SETTLE_MATCHES readings in a row are within
+// 1 step of the one that started the run, or the most conversions were done. Comparing
+// against the start of the run rather than the reading before catches a slow creep.
+// Also runs inside the ISR.
+void MCUVoltage::discardSettling(unsigned long reading)
+{
+  // Unsigned, so this is true when reading is settleReading-1, settleReading or settleReading+1
+  if (reading - settleReading + 1 <= 2) { settleMatches++; }
+
+  // Moved too far, start a new run from this reading
+  else
+  {
+    settleReading = reading;
+    settleMatches = 0;
+  }
+
+  bool matched = settleMatches >= MCUVOLTAGE_SETTLE_MATCHES;
+
+  #if MCUVOLTAGE_STATS
+    stats.discarded++;
+  #endif
+
+  if (settleCount > 0) { settleCount--; }
+
+  if ( matched || settleCount == 0 || micros() - switchMicros >= MCUVOLTAGE_SETTLE_US ) { settling = false; }
+}
+
+
+/*================================================================================*/
+
+
+// Throw away readings until the bandgap settles, returns at once if it already has
+void MCUVoltage::settle()
+{
+  while (isSettling()) { discardSettling(convert()); }
+}
+
+
+/*================================================================================*/
+
+
+// Choose how fast the ADC runs, TIMING_UNCHANGED leaves it to the core.
+// Applied on the next setup. Returns false if the profile is not known.
+bool MCUVoltage::setTiming(byte profile)
+{
+  if (profile > TIMING_PRECISE) { return false; }
+
+  timing = profile;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+byte MCUVoltage::getTiming()
+{
+  return timing;
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,303 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* Vcc Threshold (Window Comparator) Methods */
+
+
+#include "MCUVoltage.h"
+#include <avr/interrupt.h>
+
+
+//******************** 2021 MCU ********************//
+//Compile only for ATtiny 3224/3226/3227
+#if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+
+  // 16 samples are accumulated in burst mode for every result compared, so a single noisy
+  // sample does not leave the window. Thresholds are in 16 bits (12 + 4). The single modes
+  // ignore SAMPNUM, so the burst command is needed for RESULT to hold the sum.
+  #define SAMPNUM_WATCH 0b00000100
+  #define COMMAND_WATCH 0b01000000
+  #define EXTRABITS_WATCH 4
+
+  // Window compare interrupt. Nothing outside this file calls into it, so with dot_a_linkage
+  // it is only linked in, and the vector claimed, when the sketch uses watch()
+  ISR(ADC0_WCMP_vect)
+  {
+    MCUVoltage::handleWindowInterrupt();
+  }
+
+  // Called by the window compare interrupt, pass the result to the instance watching
+  void MCUVoltage::handleWindowInterrupt()
+  {
+    MCUVoltage* instance = activeInstance;
+
+    // Reading RESULT clears the result ready flag, the window flag is cleared by writing 1
+    unsigned long reading = ADC0.RESULT;
+    ADC0.INTFLAGS = 0b00000010;
+
+    if (instance != NULL && instance->watching) { instance->windowLeft(reading); }
+  }
+
+  // Let the ADC compare every result against the thresholds by itself
+  void MCUVoltage::startWatching(byte windowMode)
+  {
+    // Compare RESULT (WINSRC, Bit 3 is 0) with WINCM (Bit 2:0)
+    ADC0.CTRLD = (ADC0.CTRLD & 0b11110000) | windowMode;
+
+    // Clear any old window flag first, else the ISR fires immediately, then enable WCMP (Bit 1)
+    ADC0.INTFLAGS = 0b00000010;
+    ADC0.INTCTRL |= 0b00000010;
+
+    // Enable freerun (Bit 5), the CPU is not needed until the window is left
+    ADC0.CTRLF |= 0b00100000;
+    ADC0.COMMAND |= 0b00000001;
+  }
+
+  void MCUVoltage::endWatching()
+  {
+    // Disable WCMP interrupt and window compare
+    ADC0.INTCTRL &= ~(0b00000010);
+    ADC0.CTRLD &= ~(0b00000111);
+
+    // Disable freerun and stop the conversion
+    ADC0.CTRLF &= ~(0b00100000);
+    ADC0.COMMAND &= ~(0b00000111);
+  }
+
+
+//******************** 2016-2020 MCU ********************//
+// Compile only for tinyAVR 0/1-series, megaAVR 0-series and AVR Dx
+#elif MCUVOLTAGE_SAMPNUM_ADC
+
+  // 16 samples are accumulated for every result compared, so a single noisy sample
+  // does not leave the window. Thresholds are in 14 bits (10 + 4), 16 bits on the AVR Dx.
+  #define SAMPNUM_WATCH 0b00000100
+  #define EXTRABITS_WATCH 4
+
+  // Window compare interrupt. Nothing outside this file calls into it, so with dot_a_linkage
+  // it is only linked in, and the vector claimed, when the sketch uses watch().
+  // The AVR Dx calls it WCMP, the others WCOMP.
+  #if defined(ADC0_WCOMP_vect_num)
+  ISR(ADC0_WCOMP_vect)
+  #else
+  ISR(ADC0_WCMP_vect)
+  #endif
+  {
+    MCUVoltage::handleWindowInterrupt();
+  }
+
+  // Called by the window compare interrupt, pass the result to the instance watching
+  void MCUVoltage::handleWindowInterrupt()
+  {
+    MCUVoltage* instance = activeInstance;
+
+    // Reading RES clears the result ready flag, the window flag is cleared by writing 1
+    unsigned long reading = ADC0.RES;
+    ADC0.INTFLAGS = 0b00000010;
+
+    if (instance != NULL && instance->watching) { instance->windowLeft(reading); }
+  }
+
+  // Let the ADC compare every result against the thresholds by itself
+  void MCUVoltage::startWatching(byte windowMode)
+  {
+    // Compare RES with WINCM (Bit 2:0)
+    ADC0.CTRLE = windowMode;
+
+    // Clear any old window flag first, else the ISR fires immediately, then enable WCMP (Bit 1)
+    ADC0.INTFLAGS = 0b00000010;
+    ADC0.INTCTRL |= 0b00000010;
+
+    // Enable freerun (Bit 1), the CPU is not needed until the window is left
+    ADC0.CTRLA |= 0b00000010;
+    ADC0.COMMAND = 0b00000001;
+  }
+
+  void MCUVoltage::endWatching()
+  {
+    // Disable WCMP interrupt and window compare
+    ADC0.INTCTRL &= ~(0b00000010);
+    ADC0.CTRLE = 0b00000000;
+
+    // Disable freerun, the conversion in progress finishes by itself
+    ADC0.CTRLA &= ~(0b00000010);
+  }
+
+
+//******************** TRADITIONAL MCU ********************//
+#else
+
+  // Single conversions are compared
+  #define EXTRABITS_WATCH 0
+
+  // The analog comparator can only compare the bandgap against a pin, so the ADC
+  // converts on every Timer0 overflow (about 1kHz with the Arduino core) and the ADC
+  // interrupt compares the result. millis() keeps Timer0 running, it is not changed.
+  void MCUVoltage::startWatching(byte windowMode)
+  {
+    // An open side has its threshold at the end of the range, so the ISR needs no mode
+    (void)windowMode;
+
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+
+      // Timer0 overflow is 0100 for ADTS3:0
+      ADCSRB = (ADCSRB & 0b11110000) | 0b00000100;
+
+    #else
+
+      // Timer0 overflow is 100 for ADTS2:0
+      ADCSRB = (ADCSRB & 0b11111000) | 0b00000100;
+
+    #endif
+
+    // Enable auto trigger (Bit 5), the first conversion starts on the next overflow
+    ADCSRA |= 0b00100000;
+
+    enableADCInterrupt();
+  }
+
+  void MCUVoltage::endWatching()
+  {
+    disableADCInterrupt();
+
+    // Disable auto trigger ~(0b00100000) is 0b11011111
+    ADCSRA &= 0b11011111;
+
+    // Back to free running as the trigger source
+    #if defined (__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__)
+      ADCSRB &= 0b11110000;
+    #else
+      ADCSRB &= 0b11111000;
+    #endif
+  }
+
+#endif
+
+
+/*================================================================================*/
+
+
+// Call myCallback once Vcc goes below lowmV or above highmV, without polling.
+// Pass 0 for either to leave that side open. The callback gets Vcc in millivolts and
+// watching stops, call watch() again to go on. Returns false if the ADC is in use
+// or the thresholds make no sense.
+bool MCUVoltage::watch(unsigned int lowmV, unsigned int highmV, MCUVoltageCallback myCallback)
+{
+  if (lowmV == 0 && highmV == 0) { return false; }
+  if (highmV != 0 && lowmV > highmV) { return false; }
+
+  // ADC is being used by another reading
+  if (activeInstance != NULL) { return false; }
+  activeInstance = this;
+
+  mode = REGULAR_READING;
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+    setupRegisters(SAMPNUM_WATCH, COMMAND_WATCH);
+  #elif MCUVOLTAGE_SAMPNUM_ADC
+    setupRegisters(SAMPNUM_WATCH);
+  #else
+    setupRegisters();
+  #endif
+
+  // The window would be left at once while the bandgap settles
+  settle();
+
+  // Higher Vcc is a lower reading, so highmV gives the low threshold and lowmV the high one
+  const byte    watchBitDepth = bitDepth + EXTRABITS_WATCH;
+  const unsigned long maxReading = (1UL << watchBitDepth) - 1;
+
+  unsigned long lowThreshold = highmV != 0 ? convertToReading(highmV, watchBitDepth) : 0;
+  unsigned long highThreshold = lowmV != 0 ? convertToReading(lowmV, watchBitDepth) : maxReading;
+
+  if (highThreshold > maxReading) { highThreshold = maxReading; }
+  if (lowThreshold > maxReading) { lowThreshold = maxReading; }
+
+  // Window modes, same as WINCM of ADC0.CTRLD (ADC0.CTRLE on the tinyAVR 0/1, megaAVR 0 and AVR Dx): 1 below, 2 above, 4 outside
+  byte windowMode;
+  if (lowmV == 0) { windowMode = 1; }
+  else if (highmV == 0) { windowMode = 2; }
+  else { windowMode = 4; }
+
+  #if defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__) || MCUVOLTAGE_SAMPNUM_ADC
+    ADC0.WINLT = lowThreshold;
+    ADC0.WINHT = highThreshold;
+  #endif
+
+  lowThreshold_Watch = lowThreshold;
+  highThreshold_Watch = highThreshold;
+  callback_Watch = myCallback;
+  watching = true;
+  ready = false;
+  busy = true;
+
+  startWatching(windowMode);
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Runs inside the ISR once a reading is out of the window
+void MCUVoltage::windowLeft(unsigned long reading)
+{
+  endWatching();
+
+  watching = false;
+  busy = false;
+  activeInstance = NULL;
+
+  // Back to the native bit depth, rounded
+  #if EXTRABITS_WATCH > 0
+    lastADCReading = (reading + (1UL << (EXTRABITS_WATCH - 1))) >> EXTRABITS_WATCH;
+  #else
+    lastADCReading = reading;
+  #endif
+
+  ready = true;
+
+  if (callback_Watch != NULL) { callback_Watch(convertToVcc(reading, bitDepth + EXTRABITS_WATCH)); }
+}
+
+
+/*================================================================================*/
+
+
+// Stop watching without calling the callback
+void MCUVoltage::stopWatching()
+{
+  if (activeInstance != this || !watching) { return; }
+
+  // The ISR must not see half of this
+  byte oldSREG = SREG;
+  cli();
+
+  endWatching();
+
+  watching = false;
+  busy = false;
+  activeInstance = NULL;
+
+  SREG = oldSREG;
+}
+
+
+/*================================================================================*/
+
+
+// True while waiting for Vcc to leave the window
+bool MCUVoltage::isWatching()
+{
+  return watching;
+}
+
+
+/*================================================================================*/
@@ -0,0 +1,276 @@
+/*  MCU Voltage by cygig v0.4.4
+ *  MCUVoltage measures the voltage supply (Vcc) of Arduino without extra components.
+ *  Supported board includes Uno, Leonardo, Mega as well as the ATtiny 3224/3226/3227.
+ *  This library also supports oversampling and averaging.
+ *  Hardware oversampling for the ATtiny 3224/3226/3227 is also supported.
+ *
+ *  https://github.com/cygig/MCUVoltage
+*/
+
+/* ATtiny3224/3226/3227 Zoom Methods */
+
+
+#include "MCUVoltage.h"
+
+
+// Methods in this page will only be compiled for ATtiny 3224/3226/3227,
+// the only ones with a PGA in front of the ADC
+#if MCUVOLTAGE_ZOOM
+
+
+// Readings further than this from 0 are taken as Vcc out of the window.
+// Full scale is +-2048, the PGA is not linear right up to it.
+#define LIMIT_ZOOM 2000
+
+// Gain used when there is no operating point yet
+#define DEFAULT_GAIN_ZOOM 16
+
+
+/*================================================================================*/
+
+
+// round(n*625/d), without n*625 overflowing. d must be at most 2^19.
+static unsigned long times625(unsigned long n, unsigned long d)
+{
+  return (n / d) * 625 + ((n % d) * 625 + d/2) / d;
+}
+
+
+/*================================================================================*/
+
+
+// Set DACREF0 to the nearest of Vcc/10 at centremV, with the bandgap in use.
+// Returns false, and nothing changes, if it is out of the range of DACREF0.
+bool MCUVoltage::centre_Zoom(unsigned long centremV)
+{
+  // DACREF0 = Vcc/10 * 256/bandgap, the bandgap has fraction bits
+  unsigned long myDACREF = (centremV * 1024 + 5UL * bandgap_Compensated / 2) / (5UL * bandgap_Compensated);
+
+  if (centremV > 65535UL || myDACREF < 1 || myDACREF > 255) { return false; }
+
+  dacref_Zoom = myDACREF;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Zoom in on Vcc around centremV, where gain is 1, 2, 4, 8 or 16. Vcc can be read within about
+// +-10V/gain of it, +-625mV at a gain of 16. Returns false, and nothing changes, for any other
+// gain or if centremV is out of the range of DACREF0.
+bool MCUVoltage::setZoom(unsigned long centremV, byte gain)
+{
+  if (gain < 1 || gain > 16 || (gain & (gain - 1)) != 0) { return false; }
+
+  if (!centre_Zoom(centremV)) { return false; }
+
+  gain_Zoom = gain;
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Setup to read Vcc/10 against DACREF0, differential through the PGA, against the 1.024V reference.
+// Returns false without touching the ADC if it is already set up this way.
+bool MCUVoltage::setupRegisters_Zoom()
+{
+  // GAIN (Bit 7:5) 2^n, full bias current (Bit 4:3), 15 cycles sampling the PGA (Bit 2:1), PGA on (Bit 0)
+  byte myPGACTRL = 0b00000011;
+
+  for (byte g = gain_Zoom; g > 1; g >>= 1) { myPGACTRL += 0b00100000; }
+
+  // Prescaler and sample duration, does not need a reading thrown away
+  setupTiming();
+
+  // Check what is in the registers rather than what we last wrote,
+  // so changes made by analogRead() or other code are caught too.
+  bool switched = !( VREF.CTRLA == 0b00000000 &&
+                     AC0.DACREF == dacref_Zoom &&
+                     (ADC0.CTRLA & 0b00000001) &&
+                     ADC0.MUXPOS == 0b01110001 &&
+                     ADC0.MUXNEG == 0b01110011 &&
+                     ADC0.PGACTRL == myPGACTRL &&
+                     (ADC0.CTRLC & 0b00000111) == 0b00000100 );
+
+  if ( !switched &&
+       ADC0.CTRLF == 0b00000000 &&
+       (ADC0.COMMAND & 0b11110000) == 0b10010000 )
+  {
+    return false;
+  }
+
+  // Set reference voltage to 1.024V, for both DACREF0 and the ADC
+  VREF.CTRLA = 0b00000000;
+
+  // Operating point, DACREF0 = DACREF/256*1.024V
+  AC0.DACREF = dacref_Zoom;
+
+  // Enable ADC, ignore RUNSTDBY and LOWLAT
+  ADC0.CTRLA |= 0b00000001;
+
+  ADC0.PGACTRL = myPGACTRL;
+
+  // Vcc/10 minus DACREF0, both via the PGA (Bit 7:6)
+  ADC0.MUXPOS = 0b01110001;
+  ADC0.MUXNEG = 0b01110011;
+
+  // Freerun and left adj disabled, single sample
+  ADC0.CTRLF = 0b00000000;
+
+  // Compare against the 1.024V reference, ignore TIMEBASE
+  ADC0.CTRLC = (ADC0.CTRLC & 0b11111000) | 0b00000100;
+
+  // Differential (Bit 7), single 12 bit mode
+  ADC0.COMMAND = 0b10010000;
+
+  // The PGA and DACREF0 need time to settle from now
+  if (switched) { startSettling(); }
+
+  #if MCUVOLTAGE_STATS
+    stats.setups++;
+  #endif
+
+  return true;
+}
+
+
+/*================================================================================*/
+
+
+// Vcc in microvolts from the sum of count differential readings.
+// Vcc/10 = reference*(DACREF/256 + reading/(2048*gain)), since DACREF0 and the ADC share the reference,
+// so Vcc = bandgap_Compensated*625/128*DACREF + bandgap_Compensated*625/(1024*gain)*reading
+// with the reference as the bandgap, then moved to the bandgap of the regular readings.
+unsigned long MCUVoltage::convertToVcc_Zoom(long sumOfReadings, byte count)
+{
+  bool negative = sumOfReadings < 0;
+  unsigned long magnitude = negative ? -sumOfReadings : sumOfReadings;
+
+  // Average reading with 4 fraction bits, at most LIMIT_ZOOM*16 so the product below fits
+  magnitude = (magnitude * 16 + count/2) / count;
+
+  long uV = times625((unsigned long)bandgap_Compensated * dacref_Zoom, 128);
+  unsigned long step = times625((unsigned long)bandgap_Compensated * magnitude, 16384UL * gain_Zoom);
+
+  uV = negative ? uV - (long)step : uV + (long)step;
+
+  // The bandgap of the regular readings is DACREF0 at 255, 255/256 of the reference used here
+  uV = ((unsigned long)uV * 256 + 127) / 255;
+
+  // Calibrated offset, in millivolts
+  uV += (long)offset_Calibration * 1000;
+
+  return uV > 0 ? uV : 0;
+}
+
+
+/*================================================================================*/
+
+
+// Read Vcc in microvolts zoomed in around the operating point set by setZoom(), averaging avgTimes
+// readings. Readings are thrown away until the PGA and DACREF0 settle if the ADC was set up again.
+// With no operating point yet, a regular reading sets it. If Vcc is out of the window, a regular
+// reading is returned instead and the window moves to it, see isInWindow_Zoom().
+unsigned long MCUVoltage::readuV_Zoom(byte avgTimes)
+{
+  // Min averaging times is 1
+  if (avgTimes <1){ avgTimes=1; }
+
+  // Centre on Vcc as it is now
+  if (gain_Zoom == 0)
+  {
+    unsigned long mV = readmV(avgTimes);
+
+    if (!setZoom(mV, DEFAULT_GAIN_ZOOM))
+    {
+      inWindow_Zoom = false;
+      return mV * 1000;
+    }
+  }
+
+  mode = REGULAR_READING;
+
+  // Temperature first, it needs the ADC too
+  refreshTemperature();
+
+  setupRegisters_Zoom();
+  settle();
+
+  long sumOfReadings = 0;
+
+  for (byte i=0; i<avgTimes; i++)
+  {
+    // Signed, sign extended to 32 bits of RESULT
+    long reading = (int32_t)convert();
+
+    // Out of the window, fall back to a regular reading and move the window to it
+    if (reading > LIMIT_ZOOM || reading < -LIMIT_ZOOM)
+    {
+      inWindow_Zoom = false;
+
+      unsigned long mV = readmV(avgTimes);
+      centre_Zoom(mV);
+
+      return mV * 1000;
+    }
+
+    sumOfReadings += reading;
+  }
+
+  inWindow_Zoom = true;
+
+  return convertToVcc_Zoom(sumOfReadings, avgTimes);
+}
+
+
+/*================================================================================*/
+
+
+// Same as readuV_Zoom(byte avgTimes), rounded to millivolts
+unsigned long MCUVoltage::readmV_Zoom(byte avgTimes)
+{
+  return (readuV_Zoom(avgTimes) + 500) / 1000;
+}
+
+
+/*================================================================================*/
+
+
+// True if the last zoomed reading was within the window, false if it fell back to a regular reading
+bool MCUVoltage::isInWindow_Zoom()
+{
+  return inWindow_Zoom;
+}
+
+
+/*================================================================================*/
+
+
+// Vcc in millivolts at the middle of the window, 0 if there is no operating point yet
+unsigned long MCUVoltage::getCentre_Zoom()
+{
+  if (gain_Zoom == 0) { return 0; }
+
+  // A reading of 0 is right at DACREF0
+  return (convertToVcc_Zoom(0, 1) + 500) / 1000;
+}
+
+
+/*================================================================================*/
+
+
+// Gain set by setZoom(), 0 if there is no operating point yet
+byte MCUVoltage::getGain_Zoom()
+{
+  return gain_Zoom;
+}
+
+
+/*================================================================================*/
+
+#endif